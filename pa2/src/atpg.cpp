@@ -14,12 +14,35 @@ ATPG::ATPG() {
   this->total_attempt_num = 1;    /* default value */
   this->fsim_only = false;        /* flag to indicate fault simulation only */
   this->ndet = 1;                 /* Bonus: number of detect time */
+  this->packet_size = 16;         /* faults per fault simulation packet */
+  this->rail_words = 0;           /* dual-rail storage is allocated on first use */
+  this->fault_sim_kernel = nullptr;
+  this->ppsfp = false;            /* -fsim uses the pattern-by-pattern simulator */
+  this->gsim_only = false;        /* flag to indicate good machine simulation only */
+  this->use_compiled_sim = false; /* the engines interpret the compiled netlist */
+  this->compiled_handle = nullptr;
+  this->compiled_good_sim = nullptr;
+  this->compiled_evaluate = nullptr;
+  this->num_of_threads = 1;       /* single-threaded fault simulation */
+  this->use_circuit_cache = true; /* keep a binary image of the circuit next to it */
+  this->compaction_limit = 0;     /* one fault per vector */
+  this->static_compaction = false; /* keep every generated vector */
+  this->random_limit = 0;         /* podem from the first fault on */
+  this->fault_order = FAULT_ORDER_LIST; /* the order of the fault list */
+  this->worklist_next = 0;
+  this->fsim_job = nullptr;
+  this->fsim_generation = 0;
+  this->fsim_pending = 0;
+  this->fsim_quit = false;
+  this->imply_pending = 0;        /* nothing scheduled for the podem implication */
+  this->backward_generation = 0;
   
   /* orginally assigned in input.c */
   this->debug = 0;                /* != 0 if debugging;  this is a switch of debug mode */
   this->lineno = 0;               /* current line number */
   this->targc = 0;                /* number of args on current command line */
   this->file_no = 0;              /* number of current file */
+  this->num_input_node = 0;
   
   /* orginally assigned in init_flist.c */
   this->num_of_gate_fault = 0; // totle number of faults in the whole circuit
@@ -28,14 +51,16 @@ ATPG::ATPG() {
   this->in_vector_no = 0;         /* number of test vectors generated */
 }
 
+/* constructor of NAME_TABLE */
+ATPG::NAME_TABLE::NAME_TABLE() {
+  this->num_of_entry = 0;
+}
+
 /* constructor of WIRE */
 ATPG::WIRE::WIRE() {
   this->value = 0;
   this->flag = 0;
   this->level = 0;
-  this->wire_value1 = 0;
-  this->wire_value2 = 0;
-  this->fault_flag = 0;
   this->wlist_index = 0;
 }
 
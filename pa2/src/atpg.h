@@ -11,6 +11,7 @@
 #include <vector>
 #include <list>
 #include <forward_list>
+#include <unordered_map>
 #include <array>
 #include <memory>
 #include <iostream>
@@ -19,11 +20,13 @@
 #include <cstdio>
 #include <cstdlib>
 #include <ctime>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <cassert>
 #include <set>
 
-#define HASHSIZE 3911
-
 /* types of gate */
 #define NOT       1
 #define NAND      2
@@ -58,11 +61,18 @@
 #define STUCK1         1
 #define ALL_ONE        0xffffffff // for parallel fault sim; 2 ones represent a logic one
 #define ALL_ZERO       0x00000000 // for parallel fault sim; 2 zeros represent a logic zero
+#define ALL_ONE64      0xffffffffffffffffULL // for dual-rail fault sim; every slot set
+#define ALL_ZERO64     0x0000000000000000ULL // for dual-rail fault sim; every slot clear
 
 /* possible values for fault->faulty_net_type */
 #define GI 0
 #define GO 1
 
+/* orders of the faults given to podem, see build_fault_worklist */
+#define FAULT_ORDER_LIST  0
+#define FAULT_ORDER_LEVEL 1
+#define FAULT_ORDER_SCOAP 2
+
 /* 4-valued logic */
 #define U  2
 #define D  3
@@ -81,11 +91,27 @@ public:
   void set_total_attempt_num(const int&);
   void set_backtrack_limit(const int&);
   void set_ndet(const int&);
+  void set_packet_size(const int&);
+  void set_ppsfp(const bool&);
+  void set_num_of_threads(const int&);
+  void set_circuit_cache(const bool&);
+  void set_pattern_file(const string&);
+  void set_gsim_only(const bool&);
+  void set_compiled_sim(const bool&);
+  void set_compaction_limit(const int&);
+  void set_static_compaction(const bool&);
+  void set_random_limit(const int&);
+  void set_fault_order(const int&);
+  bool get_gsim_only(void) { return gsim_only; }
   
   /* defined in input.cpp */
   void input(const string&);
   void timer(FILE*, const string&);
   
+  /* defined in cache.cpp */
+  bool load_circuit_cache(const string&);
+  void save_circuit_cache(void);
+  
   /* defined in level.cpp */
   void level_circuit(void);
   void rearrange_gate_inputs(void);
@@ -95,6 +121,19 @@ public:
   void generate_fault_list(void);
   void compute_fault_coverage(void);
   
+  /* defined in netlist.cpp */
+  void pack_circuit(void);
+  void compile_netlist(void);
+  
+  /* defined in scoap.cpp */
+  void compute_scoap(void);
+  
+  /* defined in cone.cpp */
+  void compute_fanout_cones(void);
+  
+  /* defined in compiled.cpp */
+  bool load_compiled_sim(void);
+  
   /* defined in test.cpp */
   void test(void);
   
@@ -104,64 +143,175 @@ private:
   class WIRE;
   class NODE;
   class FAULT;
+  class TOKEN;
   typedef WIRE*  wptr;                 /* using pointer to access/manipulate the instances of WIRE */
   typedef NODE*  nptr;                 /* using pointer to access/manipulate the instances of NODE */
   typedef FAULT* fptr;                 /* using pointer to access/manipulate the instances of FAULT */
-  typedef unique_ptr<WIRE>  wptr_s;    /* using smart pointer to hold/maintain the instances of WIRE */
-  typedef unique_ptr<NODE>  nptr_s;    /* using smart pointer to hold/maintain the instances of NODE */
-  typedef unique_ptr<FAULT> fptr_s;    /* using smart pointer to hold/maintain the instances of FAULT */
+
+  /* open-addressing hash table from a name to an index, defined in input.cpp.
+   * the names are not copied, see insert */
+  class NAME_TABLE {
+  public:
+    NAME_TABLE();
+    
+    int find(const TOKEN&) const;
+    void insert(const TOKEN&, const int&);
+    
+  private:
+    vector<TOKEN> key;         /* name in each slot */
+    vector<uint64_t> code;     /* hash of the name in each slot */
+    vector<int> index;         /* value in each slot, -1 if the slot is free */
+    int num_of_entry;          /* number of used slots */
+    
+    static uint64_t hash(const TOKEN&);
+    void grow(void);
+  };
+
+  /* storage of the objects of one class.  the objects are constructed in
+   * chunks of contiguous memory, never move, and are destroyed all at once
+   * when the pool is cleared or destroyed */
+  template<class T> class POOL {
+  public:
+    POOL() : num_of_object(0) {}
+    
+    /* construct a new object in the current chunk */
+    T* create(void) {
+      if (chunk.empty() || (chunk.back().size() == chunk.back().capacity())) {
+        reserve(min(max(num_of_object, (size_t) 256), (size_t) 65536));
+      }
+      chunk.back().emplace_back();
+      num_of_object++;
+      return &chunk.back().back();
+    }
+    
+    /* start a new chunk, so that the next n objects are contiguous */
+    void reserve(const size_t& n) {
+      chunk.emplace_back();
+      chunk.back().reserve(n);
+    }
+    
+    void clear(void) { chunk.clear(); num_of_object = 0; }
+    void swap(POOL& p) { chunk.swap(p.chunk); std::swap(num_of_object, p.num_of_object); }
+    
+  private:
+    vector<vector<T> > chunk;  /* a chunk never grows beyond its capacity */
+    size_t num_of_object;
+  };
+
+  /* test patterns, two bits per primary input (0, 1 or U) and 32 inputs per
+   * word.  pattern p occupies words [p * num_of_word, (p + 1) * num_of_word) */
+  class PATTERN_STORE {
+  public:
+    PATTERN_STORE() : num_of_input(0), num_of_word(0), num_of_pattern(0) {}
+    
+    void reset(const int&);
+    int add(void);
+    int add(const char*, const char*);
+    bool read(const string&);
+    bool write(const string&) const;
+    int size(void) const { return num_of_pattern; }
+    int inputs(void) const { return num_of_input; }
+    void set_target(const int& p, const int& f) { target[p] = f; }
+    void keep(const vector<uint64_t>&);
+    
+    /* value of input i under pattern p */
+    int get(const int& p, const int& i) const {
+      return (int) ((bits[(size_t) p * num_of_word + (i >> 5)] >> ((i & 31) << 1)) & 3);
+    }
+    void set(const int& p, const int& i, const int& v) {
+      uint64_t& word = bits[(size_t) p * num_of_word + (i >> 5)];
+      word = (word & ~(3ULL << ((i & 31) << 1))) | ((uint64_t) v << ((i & 31) << 1));
+    }
+    
+  private:
+    int num_of_input;
+    int num_of_word;           /* words per pattern */
+    int num_of_pattern;
+    vector<uint64_t> bits;
+    vector<int> target;        /* fault_no of the fault each pattern was generated for, -1 if none */
+  };
 
   /* orginally declared in miscell.h */
-  forward_list<fptr_s> flist;          /* fault list */
+  forward_list<fptr> flist;            /* fault list */
   forward_list<fptr> flist_undetect;   /* undetected fault list */
 
   /* orginally declared in global.h */
   vector<wptr> sort_wlist;             /* sorted wire list with regard to level */
   vector<wptr> cktin;                  /* input wire list */
   vector<wptr> cktout;                 /* output wire list */
-  array<forward_list<wptr_s>,HASHSIZE> hash_wlist;   /* hashed wire list */
-  array<forward_list<nptr_s>,HASHSIZE> hash_nlist;   /* hashed node list */
+  POOL<WIRE> wire_pool;                /* storage of the wires */
+  POOL<NODE> node_pool;                /* storage of the nodes */
+  POOL<FAULT> fault_pool;              /* storage of the faults */
+  vector<wptr> wlist;                  /* all wires, in the order of creation until pack_circuit */
+  vector<nptr> nlist;                  /* all nodes, in the order of creation until pack_circuit */
+  NAME_TABLE wire_table;               /* index of every wire name into wlist */
+  NAME_TABLE node_table;               /* index of every node name into nlist */
   int in_vector_no;                    /* number of test vectors generated */
-  vector<string> vectors;              /* vector set */
+  PATTERN_STORE patterns;              /* vector set */
   
   /* orginally declared in tpgmain.c */
   int backtrack_limit;
   int total_attempt_num;
   bool fsim_only;                      /* flag to indicate fault simulation only */
   int ndet;
+  int packet_size;                     /* number of faults simulated per packet (16, 64, 256 or 512) */
+  bool ppsfp;                          /* flag to use the parallel-pattern fault simulator for -fsim */
+  bool gsim_only;                      /* flag to indicate good machine simulation only */
+  bool use_compiled_sim;               /* flag to run the pattern-parallel engines on code compiled for the circuit */
+  int num_of_threads;                  /* number of fault simulation threads */
+  bool use_circuit_cache;              /* flag to read and write the binary circuit cache */
+  string pattern_file;                 /* binary pattern file written in ATPG mode, if not empty */
+  int compaction_limit;                /* secondary faults tried per vector in dynamic compaction, 0 if off */
+  bool static_compaction;              /* flag to drop the unneeded vectors after ATPG, see compact_patterns */
+  int random_limit;                    /* random vectors until a block of 64 detects fewer faults, 0 if none */
+  int fault_order;                     /* FAULT_ORDER_LIST, FAULT_ORDER_LEVEL or FAULT_ORDER_SCOAP */
   
   /* orginally declared input.c */
   int debug;                           /* != 0 if debugging;  this is a switch of debug mode */
   string filename;                     /* current input file */
   int lineno;                          /* current line number */
-  string targv[100];                   /* tokens on current command line */
+  vector<TOKEN> targv;                 /* tokens on current command line */
   int targc;                           /* number of args on current command line */
   int file_no;                         /* number of current file */
+  int num_input_node;                  /* number of gates read from the circuit file */
   double StartTime, LastTime;
   
-  int hashcode(const string&);
-  wptr wfind(const string&);
-  nptr nfind(const string&);
-  wptr getwire(const string&);
-  nptr getnode(const string&);
+  wptr wfind(const TOKEN&);
+  nptr nfind(const TOKEN&);
+  wptr getwire(const TOKEN&);
+  nptr getnode(const TOKEN&);
   void newgate(void);
   void set_output(void);
   void set_input(const bool&);
-  void parse_line(const string&);
+  void parse_line(const char*, const char*);
   void create_structure(void);
-  int FindType(const string&);
+  int FindType(const TOKEN&);
   void error(const string&);
   void display_circuit(void);
+  void display_circuit_summary(const int&, const int&);
   //void create_structure(void);
   
+  /* defined in cache.cpp */
+  bool hash_circuit_file(const string&, uint64_t&, uint64_t&);
+  
   /* orginally declared in init_flist.c */
   int num_of_gate_fault;
   
   char itoc(const int&);
   
+  /* defined in netlist.cpp */
+  vector<int> gate_type;            /* type of the gate driving each wire, indexed by wlist_index */
+  vector<int> fanin_start;          /* gate inputs of wire i are fanin_index[fanin_start[i]..fanin_start[i+1]) */
+  vector<int> fanin_index;
+  vector<int> fanout_start;         /* wires fed by wire i are fanout_index[fanout_start[i]..fanout_start[i+1]) */
+  vector<int> fanout_index;
+  vector<unsigned int> wire_value1; /* (32 bits) fault-free value, [00|11|01] replicated by 16 times (for pfedfs) */
+  vector<unsigned int> wire_value2; /* (32 bits) values in the presence of 16 faults (for pfedfs) */
+  vector<unsigned int> fault_flag;  /* the fault-injected bit positions (for pfedfs) */
+
   /* orginally declared in sim.c */
   void sim(void);
-  void evaluate(nptr);
+  void evaluate(const int&);
   int ctoi(const char&);
   
   /* orginally declared in faultsim.c */
@@ -176,38 +326,149 @@ private:
   forward_list<wptr> wlist_faulty;  // faulty wire linked list
   
   void fault_simulate_vectors(int&);
-  void fault_sim_a_vector(const string&, int&);
-  void fault_sim_evaluate(const wptr);
+  void fault_sim_a_vector(const int&, int&);
+  void fault_sim_evaluate(const int&);
   wptr get_faulty_wire(const fptr, int&);
   void inject_fault_value(const wptr, const int&, const int&);
-  void combine(const wptr, unsigned int&);
+  void combine(const int&, unsigned int&);
   unsigned int PINV(const unsigned int&);
   unsigned int PEXOR(const unsigned int&, const unsigned int&);
   unsigned int PEQUIV(const unsigned int&, const unsigned int&);
+
+  /* defined in faultsim64.cpp */
+  class FSIM_CONTEXT;
+  int rail_words;                   /* number of 64-bit words per rail, packet_size/64 */
+  vector<uint64_t> good_one;        /* 1-rail of the fault-free value, indexed by wlist_index */
+  vector<uint64_t> good_zero;       /* 0-rail of the fault-free value, indexed by wlist_index */
+  vector<FSIM_CONTEXT> fsim_context;   /* private faulty state, one per fault simulation thread */
+  void (ATPG::*fault_sim_kernel)(FSIM_CONTEXT&, const int&);  /* gate evaluation chosen from the CPU features */
+
+  void fault_sim_a_vector64(const int&, int&);
+  void setup_fault_sim64(void);
+  void partition_fault_list(void);
+  void fault_sim_packets64(FSIM_CONTEXT&);
+  void fault_sim_flush64(FSIM_CONTEXT&, const fptr*, const int&, const int&);
+  void select_fault_sim_kernel(void);
+  void fault_sim_evaluate64(FSIM_CONTEXT&, const int&);
+  void fault_sim_evaluate_avx2(FSIM_CONTEXT&, const int&);
+  void fault_sim_evaluate_avx512(FSIM_CONTEXT&, const int&);
+  void schedule_faulty_wire(FSIM_CONTEXT&, const int&);
+  void inject_fault_value64(FSIM_CONTEXT&, const wptr, const int&, const int&);
+
+  /* defined in fsim_thread.cpp */
+  vector<thread> fsim_worker;       /* worker threads, fsim_context[t] belongs to fsim_worker[t-1] */
+  mutex fsim_mutex;
+  condition_variable fsim_start;    /* signals the workers that a new job is posted */
+  condition_variable fsim_done;     /* signals the main thread that all workers are done */
+  void (ATPG::*fsim_job)(FSIM_CONTEXT&);  /* job of the current vector */
+  int fsim_generation;              /* number of jobs posted so far */
+  int fsim_pending;                 /* number of workers still running the current job */
+  bool fsim_quit;                   /* asks the workers to exit */
+
+  void start_fsim_workers(void);
+  void stop_fsim_workers(void);
+  void run_fsim_job(void (ATPG::*)(FSIM_CONTEXT&));
+  void fsim_worker_loop(const int, int);
+
+  /* defined in goodsim.cpp */
+  vector<uint64_t> pattern_good_one;    /* bit b set if the wire is 1 under pattern first + b of the block */
+  vector<uint64_t> pattern_good_zero;   /* bit b set if the wire is 0 under pattern first + b of the block */
+
+  void good_simulate_vectors(void);
+  void good_sim_block(const int&, const int&);
+  void pattern_sim_evaluate(const int&, const vector<uint64_t>&, const vector<uint64_t>&, uint64_t&, uint64_t&);
+
+  /* defined in compiled.cpp */
+  void *compiled_handle;               /* dlopen handle of infile.so */
+  void (*compiled_good_sim)(uint64_t*, uint64_t*);  /* good_sim_block on every gate, nullptr if not loaded */
+  void (*compiled_evaluate)(int, const uint64_t*, const uint64_t*, uint64_t*, uint64_t*);  /* pattern_sim_evaluate */
+
+  uint64_t hash_netlist(void);
+  bool open_compiled_sim(const string&, const uint64_t&);
+  bool write_compiled_source(const string&, const uint64_t&);
+
+  /* defined in scoap.cpp */
+  vector<int> cc0;                  /* SCOAP 0-controllability, indexed by wlist_index */
+  vector<int> cc1;                  /* SCOAP 1-controllability */
+  vector<int> co;                   /* SCOAP observability */
+
+  /* defined in cone.cpp */
+  vector<int> cone_root;            /* the stem reached through single fanouts, indexed by wlist_index */
+  vector<int> ffr_enter;            /* DFS range of the wire in the tree of its stem */
+  vector<int> ffr_leave;
+  vector<int> cone_start;           /* cone of stem r is cone_interval[cone_start[r]..cone_start[r+1]) */
+  vector<pair<int, int> > cone_interval;  /* [first, last] ranges of wlist_index */
+
+  bool is_fanout_stem(const int&);
+  bool in_fanout_cone(const int&, const int&);
+
+  /* defined in ppsfp.cpp */
+  vector<uint64_t> pattern_faulty_one;  /* pattern_good_one in the presence of the fault under simulation */
+  vector<uint64_t> pattern_faulty_zero;
+
+  void fault_simulate_vectors_ppsfp(int&);
+  uint64_t ppsfp_simulate_fault(const fptr);
+
+  /* defined in compact.cpp */
+  void compact_patterns(void);
   
   /* orginally declared in podem.c */
   int no_of_backtracks;  // current number of backtracks
   bool find_test;        // true when a test pattern is found
   bool no_test;          // true when it is proven that no test exists for this fault
+  vector<pair<wptr, int> > imply_trail;  /* every value written by podem and the value it replaced */
+  vector<vector<int> > imply_bucket;     /* wires scheduled for imply, one bucket per level */
+  int imply_pending;                     /* number of wires in imply_bucket */
+  vector<int> d_frontier;                /* wires fed by a D or B, a superset of the D-frontier */
+  int propagate_site;                    /* the faulty gate output, -1 for a fault on a PO */
+  vector<pair<wptr, int> > backward_stack;  /* (wire, value) pairs still to imply, see backward_imply */
+  vector<int> backward_stamp;            /* (wire, value) implied in the current call if equal to backward_generation */
+  int backward_generation;
+  vector<int> xpath_ipdom;               /* immediate post-dominator toward the POs, see compute_xpath_dominators */
+  vector<vector<int> > xpath_witness;    /* last X-path found from a wire, see trace_unknown_path */
+  vector<int> xpath_cached;              /* wires with a witness for the current fault */
+  vector<int> xpath_stamp;               /* DFS visit marks, a wire is visited if equal to xpath_generation */
+  vector<int> xpath_parent;              /* DFS predecessor of a visited wire */
+  vector<int> xpath_stack;
+  int xpath_generation;
   
   int podem(fptr, int&);
   wptr fault_evaluate(const fptr);
   void forward_imply(const wptr);
+  void trail_value(const wptr, const int&);
+  void imply_assign(const wptr, const int&);
+  void schedule_fanout(const int&);
+  void imply_evaluate(const int&);
+  void imply(void);
+  void undo_imply(const int&);
+  void clear_imply_queue(void);
+  void push_d_frontier(const int&);
+  bool in_d_frontier(const int&);
   wptr test_possible(const fptr);
   wptr find_pi_assignment(const wptr, const int&);
-  wptr find_hardest_control(const nptr);
-  wptr find_easiest_control(const nptr);
+  wptr find_hardest_control(const nptr, const int&);
+  wptr find_easiest_control(const nptr, const int&);
   nptr find_propagate_gate(const int&);
   bool trace_unknown_path(const wptr);
+  void compute_xpath_dominators(void);
   bool check_test(void);
-  void mark_propagate_tree(const nptr);
-  void unmark_propagate_tree(const nptr);
   int set_uniquely_implied_value(const fptr);
   int backward_imply(const wptr, const int&);
   
+  /* defined in test.cpp */
+  vector<int> test_cube;                 /* PI values podem starts from, empty if none; see compact_test_cube */
+  vector<fptr> fault_worklist;           /* the faults for podem, in the order they are tried */
+  int worklist_next;                     /* the faults before it are detected or tried */
+  
+  void compact_test_cube(const fptr, int&);
+  void random_pattern_phase(int&, int&);
+  void build_fault_worklist(void);
+  fptr next_fault(void);
+  
   /* orginally declared in display.c */
   void display_line(fptr);
   void display_io(void);
+  void display_pattern(const int&);
   void display_undetect(void);
   void display_fault(fptr);
     
@@ -225,12 +486,6 @@ private:
     /*short *pi_reach;*/           /* array of no. of paths reachable from each pi, for podem
                                       (this variable is not used in CCL's class) */
     
-    int wire_value1;           /* (32 bits) represents fault-free value for this wire. 
-                                  the same [00|11|01] replicated by 16 times (for pfedfs) */
-    int wire_value2;           /* (32 bits) represents values of this wire 
-                                  in the presence of 16 faults. (for pfedfs) */
-    
-    int fault_flag;            /* indicates the fault-injected bit position, for pfedfs */
     int wlist_index;           /* index into the sorted_wlist array */
   };
   
@@ -261,4 +516,37 @@ private:
     int    fault_no;              /* fault index */
     int    detect_time;           /* Bonus: number of detect times */
   };
+
+  /* a token of the circuit file: a pointer into the mapped file and a length.
+   * strings and string literals convert to tokens, so names can be compared
+   * and looked up without copying them */
+  class TOKEN {
+  public:
+    TOKEN() : str(nullptr), len(0) {}
+    TOKEN(const char *s, const int& n) : str(s), len(n) {}
+    TOKEN(const char *s) : str(s), len(strlen(s)) {}
+    TOKEN(const string& s) : str(s.data()), len(s.size()) {}
+    
+    bool empty(void) const { return (len == 0); }
+    char operator[](const int& i) const { return str[i]; }
+    bool operator==(const TOKEN& t) const { return (len == t.len) && (memcmp(str, t.str, len) == 0); }
+    bool operator!=(const TOKEN& t) const { return !(*this == t); }
+    string to_string(void) const { return string(str, len); }
+    
+    const char *str;           /* first character, not terminated */
+    int len;                   /* number of characters */
+  };
+
+  /* faulty machine state of one fault simulation thread.
+   * the good machine (value, good_one, good_zero) is shared and read-only */
+  class FSIM_CONTEXT {
+  public:
+    vector<fptr> fault_list;          /* faults simulated by this context for the current vector */
+    vector<uint64_t> faulty_one;      /* bit i set if the wire is 1 in the presence of fault i,
+                                         rail_words words per wire */
+    vector<uint64_t> faulty_zero;     /* bit i set if the wire is 0 in the presence of fault i */
+    vector<uint64_t> inject_mask;     /* bit i set if fault i is injected on the wire */
+    vector<unsigned char> flag;       /* private SCHEDULED, FAULTY and FAULT_INJECTED bits */
+    vector<wptr> wlist_faulty;        /* wires whose faulty value differs from the good value */
+  };
 };
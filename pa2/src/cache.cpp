@@ -0,0 +1,301 @@
+/**********************************************************************/
+/*           Binary cache of the compiled circuit                     */
+/*                                                                    */
+/*           <infile>.bin holds the levelled circuit and fault list   */
+/**********************************************************************/
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "atpg.h"
+
+/* The cache is a snapshot of the circuit right after generate_fault_list:
+ * the wires and nodes with their connections, the levels and sort_wlist,
+ * and the fault list.  It is written next to the circuit file the first
+ * time the circuit is read, and mapped instead of parsing the circuit on
+ * later runs.  It is ignored and rewritten when the circuit file changes
+ * (hash or size), or when CACHE_VERSION or CACHE_MAGIC does not match.
+ *
+ * Layout: a CACHE_HEADER followed by
+ *   num_wire  CACHE_WIRE     wire w is wlist[w]
+ *   num_node  CACHE_NODE     node n is nlist[n]
+ *   num_fault CACHE_FAULT    in the order of flist
+ *   num_ref   int            inode/onode/iwire/owire lists, and then
+ *                            cktin, cktout and sort_wlist
+ *   num_char  char           the wire and node names
+ * Objects refer to each other by these numbers.  The file is written in
+ * the byte order of the host; it is a cache, not an exchange format. */
+
+#define CACHE_MAGIC   "ATPGSA\0\0"  /* the fault list is for stuck-at faults */
+#define CACHE_VERSION 3
+
+struct CACHE_HEADER {
+  char magic[8];
+  int version;
+  int debug;                   /* debug switch set by the circuit file */
+  uint64_t source_hash;        /* FNV-1a hash of the circuit file */
+  uint64_t source_size;        /* size of the circuit file */
+  int num_wire, num_node, num_fault, num_ref, num_char;
+  int num_cktin, num_cktout, num_sorted;
+  int num_input_node;          /* nodes read from the circuit file, without the dummy gates */
+  int num_of_gate_fault;
+};
+
+struct CACHE_WIRE {
+  int name, name_len;          /* name is an offset into the names */
+  int flag, level, wlist_index;
+  int inode, num_inode;        /* inode is an offset into the references */
+  int onode, num_onode;
+};
+
+struct CACHE_NODE {
+  int name, name_len;
+  int type, flag;
+  int iwire, num_iwire;
+  int owire, num_owire;
+};
+
+struct CACHE_FAULT {
+  int node, io, index, fault_type;
+  int eqv_fault_num, to_swlist, fault_no;
+};
+
+/* 64-bit FNV-1a hash of the circuit file; false if it cannot be read */
+bool ATPG::hash_circuit_file(const string& infile, uint64_t& hash, uint64_t& size) {
+  int fd;
+  struct stat st;
+  const unsigned char *p;
+  uint64_t i;
+
+  fd = open(infile.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  if ((fstat(fd, &st) != 0) || (st.st_size == 0)) {
+    close(fd);
+    return false;
+  }
+  size = st.st_size;
+  p = (const unsigned char *) mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) return false;
+
+  hash = 0xcbf29ce484222325ULL;
+  for (i = 0; i < size; i++) {
+    hash ^= p[i];
+    hash *= 0x100000001b3ULL;
+  }
+  munmap((void *) p, size);
+  return true;
+}/* end of hash_circuit_file */
+
+/* rebuild the circuit and the fault list from infile.bin.
+ * return false if there is no valid cache for infile */
+bool ATPG::load_circuit_cache(const string& infile) {
+  int fd, i, j;
+  struct stat st;
+  const char *base;
+  const CACHE_HEADER *h;
+  const CACHE_WIRE *cw;
+  const CACHE_NODE *cn;
+  const CACHE_FAULT *cf;
+  const int *ref;
+  const char *names;
+  uint64_t hash, size, need;
+  vector<wptr> wire;
+  vector<nptr> node;
+  vector<fptr> fault;
+
+  filename = infile;
+  if (!use_circuit_cache) return false;
+  if (!hash_circuit_file(infile, hash, size)) return false;
+
+  fd = open((infile + ".bin").c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  if ((fstat(fd, &st) != 0) || (st.st_size < (off_t) sizeof(CACHE_HEADER))) {
+    close(fd);
+    return false;
+  }
+  base = (const char *) mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) return false;
+
+  /* check that the cache belongs to this version of this circuit file */
+  h = (const CACHE_HEADER *) base;
+  need = sizeof(CACHE_HEADER) + (uint64_t) h->num_wire * sizeof(CACHE_WIRE)
+       + (uint64_t) h->num_node * sizeof(CACHE_NODE) + (uint64_t) h->num_fault * sizeof(CACHE_FAULT)
+       + (uint64_t) h->num_ref * sizeof(int) + (uint64_t) h->num_char;
+  if ((memcmp(h->magic, CACHE_MAGIC, sizeof(h->magic)) != 0) || (h->version != CACHE_VERSION) ||
+      (h->source_hash != hash) || (h->source_size != size) || (need != (uint64_t) st.st_size)) {
+    munmap((void *) base, st.st_size);
+    return false;
+  }
+  cw = (const CACHE_WIRE *) (base + sizeof(CACHE_HEADER));
+  cn = (const CACHE_NODE *) (cw + h->num_wire);
+  cf = (const CACHE_FAULT *) (cn + h->num_node);
+  ref = (const int *) (cf + h->num_fault);
+  names = (const char *) (ref + h->num_ref);
+
+  /* allocate the objects first, so that the references can be resolved.
+   * the cache is written after pack_circuit, so one chunk per pool keeps
+   * the objects in the packed order */
+  wire_pool.reserve(h->num_wire);
+  node_pool.reserve(h->num_node);
+  fault_pool.reserve(h->num_fault);
+  for (i = 0; i < h->num_wire; i++) wire.push_back(wire_pool.create());
+  for (i = 0; i < h->num_node; i++) node.push_back(node_pool.create());
+
+  for (i = 0; i < h->num_wire; i++) {
+    wptr w = wire[i];
+    w->name.assign(names + cw[i].name, cw[i].name_len);
+    w->flag = cw[i].flag;
+    w->level = cw[i].level;
+    w->wlist_index = cw[i].wlist_index;
+    for (j = 0; j < cw[i].num_inode; j++) w->inode.push_back(node[ref[cw[i].inode + j]]);
+    for (j = 0; j < cw[i].num_onode; j++) w->onode.push_back(node[ref[cw[i].onode + j]]);
+  }
+  for (i = 0; i < h->num_node; i++) {
+    nptr n = node[i];
+    n->name.assign(names + cn[i].name, cn[i].name_len);
+    n->type = cn[i].type;
+    n->flag = cn[i].flag;
+    for (j = 0; j < cn[i].num_iwire; j++) n->iwire.push_back(wire[ref[cn[i].iwire + j]]);
+    for (j = 0; j < cn[i].num_owire; j++) n->owire.push_back(wire[ref[cn[i].owire + j]]);
+  }
+  ref += h->num_ref - (h->num_cktin + h->num_cktout + h->num_sorted);
+  for (i = 0; i < h->num_cktin; i++) cktin.push_back(wire[*ref++]);
+  for (i = 0; i < h->num_cktout; i++) cktout.push_back(wire[*ref++]);
+  for (i = 0; i < h->num_sorted; i++) sort_wlist.push_back(wire[*ref++]);
+
+  for (i = 0; i < h->num_fault; i++) {
+    fault.push_back(fault_pool.create());
+    fault[i]->node = node[cf[i].node];
+    fault[i]->io = cf[i].io;
+    fault[i]->index = cf[i].index;
+    fault[i]->fault_type = cf[i].fault_type;
+    fault[i]->eqv_fault_num = cf[i].eqv_fault_num;
+    fault[i]->to_swlist = cf[i].to_swlist;
+    fault[i]->fault_no = cf[i].fault_no;
+  }
+  debug = h->debug;
+  num_of_gate_fault = h->num_of_gate_fault;
+
+  /* hand the objects over to the object lists, the name tables and the
+   * fault lists.  pushing to the front in reverse order keeps the order */
+  for (i = 0; i < h->num_wire; i++) {
+    wire_table.insert(wire[i]->name, wlist.size());
+    wlist.push_back(wire[i]);
+  }
+  for (i = 0; i < h->num_node; i++) {
+    node_table.insert(node[i]->name, nlist.size());
+    nlist.push_back(node[i]);
+  }
+  for (i = h->num_fault - 1; i >= 0; i--) {
+    flist_undetect.push_front(fault[i]);
+    flist.push_front(fault[i]);
+  }
+
+  display_circuit_summary(h->num_input_node, h->num_wire);
+  fprintf(stdout,"#number of equivalent faults = %d\n", h->num_fault);
+  munmap((void *) base, st.st_size);
+  return true;
+}/* end of load_circuit_cache */
+
+/* write the circuit and the fault list to filename.bin.
+ * the cache is only an optimization, so a failure is silently ignored */
+void ATPG::save_circuit_cache(void) {
+  CACHE_HEADER h;
+  vector<CACHE_WIRE> cw;
+  vector<CACHE_NODE> cn;
+  vector<CACHE_FAULT> cf;
+  vector<int> ref;
+  string names, tmpname;
+  unordered_map<wptr, int> wire_no;
+  unordered_map<nptr, int> node_no;
+  FILE *file;
+  int i;
+  bool ok;
+
+  if (!use_circuit_cache) return;
+  memset(&h, 0, sizeof(h));
+  if (!hash_circuit_file(filename, h.source_hash, h.source_size)) return;
+
+  /* number the objects in the order of wlist and nlist */
+  for (i = 0; i < wlist.size(); i++) wire_no[wlist[i]] = i;
+  for (i = 0; i < nlist.size(); i++) node_no[nlist[i]] = i;
+
+  for (wptr w: wlist) {
+    CACHE_WIRE c;
+    c.name = names.size();
+    c.name_len = w->name.size();
+    names += w->name;
+    c.flag = w->flag;
+    c.level = w->level;
+    c.wlist_index = w->wlist_index;
+    c.inode = ref.size();
+    c.num_inode = w->inode.size();
+    for (nptr n: w->inode) ref.push_back(node_no[n]);
+    c.onode = ref.size();
+    c.num_onode = w->onode.size();
+    for (nptr n: w->onode) ref.push_back(node_no[n]);
+    cw.push_back(c);
+  }
+  for (nptr n: nlist) {
+    CACHE_NODE c;
+    c.name = names.size();
+    c.name_len = n->name.size();
+    names += n->name;
+    c.type = n->type;
+    c.flag = n->flag;
+    c.iwire = ref.size();
+    c.num_iwire = n->iwire.size();
+    for (wptr w: n->iwire) ref.push_back(wire_no[w]);
+    c.owire = ref.size();
+    c.num_owire = n->owire.size();
+    for (wptr w: n->owire) ref.push_back(wire_no[w]);
+    cn.push_back(c);
+  }
+  for (wptr w: cktin) ref.push_back(wire_no[w]);
+  for (wptr w: cktout) ref.push_back(wire_no[w]);
+  for (wptr w: sort_wlist) ref.push_back(wire_no[w]);
+  for (auto pos = flist.cbegin(); pos != flist.cend(); ++pos) {
+    CACHE_FAULT c;
+    c.node = node_no[(*pos)->node];
+    c.io = (*pos)->io;
+    c.index = (*pos)->index;
+    c.fault_type = (*pos)->fault_type;
+    c.eqv_fault_num = (*pos)->eqv_fault_num;
+    c.to_swlist = (*pos)->to_swlist;
+    c.fault_no = (*pos)->fault_no;
+    cf.push_back(c);
+  }
+
+  memcpy(h.magic, CACHE_MAGIC, sizeof(h.magic));
+  h.version = CACHE_VERSION;
+  h.debug = debug;
+  h.num_wire = cw.size();
+  h.num_node = cn.size();
+  h.num_fault = cf.size();
+  h.num_ref = ref.size();
+  h.num_char = names.size();
+  h.num_cktin = cktin.size();
+  h.num_cktout = cktout.size();
+  h.num_sorted = sort_wlist.size();
+  h.num_input_node = num_input_node;
+  h.num_of_gate_fault = num_of_gate_fault;
+
+  /* write to a temporary file and rename it,
+   * so that a concurrent run never maps a partial cache */
+  tmpname = filename + ".bin." + to_string(getpid());
+  file = fopen(tmpname.c_str(), "wb");
+  if (file == nullptr) return;
+  ok = (fwrite(&h, sizeof(h), 1, file) == 1);
+  ok = ok && (cw.empty() || fwrite(cw.data(), sizeof(CACHE_WIRE), cw.size(), file) == cw.size());
+  ok = ok && (cn.empty() || fwrite(cn.data(), sizeof(CACHE_NODE), cn.size(), file) == cn.size());
+  ok = ok && (cf.empty() || fwrite(cf.data(), sizeof(CACHE_FAULT), cf.size(), file) == cf.size());
+  ok = ok && (ref.empty() || fwrite(ref.data(), sizeof(int), ref.size(), file) == ref.size());
+  ok = ok && (names.empty() || fwrite(names.data(), 1, names.size(), file) == names.size());
+  ok = (fclose(file) == 0) && ok;
+  if (!ok || (rename(tmpname.c_str(), (filename + ".bin").c_str()) != 0)) {
+    remove(tmpname.c_str());
+  }
+}/* end of save_circuit_cache */
@@ -0,0 +1,126 @@
+/**********************************************************************/
+/*           Static compaction of the generated test vectors          */
+/*                                                                    */
+/*           reverse order fault simulation and greedy set cover      */
+/**********************************************************************/
+
+#include "atpg.h"
+
+/* pack 64 patterns into one block */
+#define num_of_block_pattern 64
+
+/* Drop the vectors that test() generated but are not needed for the
+ * coverage.  The detected faults are simulated again, without fault
+ * dropping, by the PPSFP simulator (ppsfp.cpp).  This gives the detection
+ * matrix: bit p of the row of a fault is set if vector p detects it.
+ *  1. reverse order: every fault is credited to the last vector that
+ *     detects it, as a fault simulation from the last vector with fault
+ *     dropping would do.  A vector credited with no fault is dropped.
+ *  2. greedy set cover of the faults by the vectors kept in 1: a vector
+ *     that alone detects a fault is taken first, then the vector detecting
+ *     the most faults not yet covered, until every fault is covered.
+ * The smaller set is kept, in the original order, so every fault detected
+ * before is still detected. */
+void ATPG::compact_patterns(void) {
+  int i, b, p, lo, hi, nckt, num_of_pattern, num_of_block, num_of_reverse, num_of_cover;
+  uint64_t valid, bits;
+  vector<fptr> fault;             // the detected faults, the rows of the matrix
+  vector<uint64_t> matrix;        // row i is matrix[i * num_of_block .. (i + 1) * num_of_block)
+  vector<uint64_t> reverse_kept;  // vectors kept by the reverse order pass
+  vector<uint64_t> cover_kept;    // vectors taken by the set cover
+  vector<int> gain;               // faults not covered yet that each vector detects
+  vector<bool> covered;
+
+  num_of_pattern = patterns.size();
+  if (num_of_pattern == 0) return;
+  num_of_block = (num_of_pattern + num_of_block_pattern - 1) / num_of_block_pattern;
+  for (fptr f: flist) {
+    if (f->detect == TRUE) fault.push_back(f);
+  }
+
+  /* the detection matrix, 64 vectors at a time */
+  nckt = sort_wlist.size();
+  pattern_faulty_one.assign(nckt, ALL_ZERO64);
+  pattern_faulty_zero.assign(nckt, ALL_ZERO64);
+  matrix.assign(fault.size() * num_of_block, ALL_ZERO64);
+  for (b = 0; b < num_of_block; b++) {
+    lo = b * num_of_block_pattern;
+    hi = min(lo + num_of_block_pattern, num_of_pattern) - 1;
+    valid = (hi - lo + 1 == num_of_block_pattern) ? ALL_ONE64 : ((1ULL << (hi - lo + 1)) - 1);
+    good_sim_block(lo, hi - lo + 1);
+    for (i = 0; i < nckt; i++) {
+      pattern_faulty_one[i] = pattern_good_one[i];
+      pattern_faulty_zero[i] = pattern_good_zero[i];
+    }
+    for (i = 0; i < fault.size(); i++) {
+      matrix[i * num_of_block + b] = ppsfp_simulate_fault(fault[i]) & valid;
+    }
+  }
+
+  /* 1. reverse order fault simulation: the highest bit of every row */
+  reverse_kept.assign(num_of_block, ALL_ZERO64);
+  for (i = 0; i < fault.size(); i++) {
+    for (b = num_of_block - 1; b >= 0; b--) {
+      bits = matrix[i * num_of_block + b];
+      if (bits) {
+        reverse_kept[b] |= 1ULL << (63 - __builtin_clzll(bits));
+        break;
+      }
+    }
+  }
+  num_of_reverse = 0;
+  for (b = 0; b < num_of_block; b++) num_of_reverse += __builtin_popcountll(reverse_kept[b]);
+
+  /* 2. greedy set cover over the vectors kept in 1 */
+  cover_kept.assign(num_of_block, ALL_ZERO64);
+  gain.assign(num_of_pattern, 0);
+  covered.assign(fault.size(), false);
+  for (i = 0; i < fault.size(); i++) {
+    int num_of_detect = 0;
+    int last = -1;
+    for (b = 0; b < num_of_block; b++) {
+      for (bits = matrix[i * num_of_block + b] & reverse_kept[b]; bits; bits &= bits - 1) {
+        last = b * num_of_block_pattern + __builtin_ctzll(bits);
+        gain[last]++;
+        num_of_detect++;
+      }
+    }
+    if (num_of_detect == 0) covered[i] = true;  // not detected again, nothing to keep
+    else if (num_of_detect == 1) cover_kept[last / num_of_block_pattern] |= 1ULL << (last % num_of_block_pattern);
+  }
+  p = -1;
+  num_of_cover = 0;
+  while (true) {
+    /* the faults detected by the vectors taken so far (first pass) or by
+     * vector p are covered now */
+    for (i = 0; i < fault.size(); i++) {
+      if (covered[i]) continue;
+      if (p < 0) {
+        for (b = 0; b < num_of_block; b++) {
+          if (matrix[i * num_of_block + b] & cover_kept[b]) break;
+        }
+        if (b == num_of_block) continue;
+      }
+      else if (!((matrix[i * num_of_block + p / num_of_block_pattern] >> (p % num_of_block_pattern)) & 1)) continue;
+      covered[i] = true;
+      for (b = 0; b < num_of_block; b++) {
+        for (bits = matrix[i * num_of_block + b] & reverse_kept[b]; bits; bits &= bits - 1) {
+          gain[b * num_of_block_pattern + __builtin_ctzll(bits)]--;
+        }
+      }
+    }
+    /* the vector detecting the most faults not covered yet */
+    p = -1;
+    for (i = 0; i < num_of_pattern; i++) {
+      if ((gain[i] > 0) && ((p < 0) || (gain[i] > gain[p]))) p = i;
+    }
+    if (p < 0) break;
+    cover_kept[p / num_of_block_pattern] |= 1ULL << (p % num_of_block_pattern);
+  }
+  for (b = 0; b < num_of_block; b++) num_of_cover += __builtin_popcountll(cover_kept[b]);
+
+  fprintf(stdout,"#static compaction: %d vectors, %d after reverse order fault simulation, %d after set cover\n",
+          num_of_pattern, num_of_reverse, num_of_cover);
+  if (num_of_cover > num_of_reverse) cover_kept.swap(reverse_kept);
+  patterns.keep(cover_kept);
+}/* end of compact_patterns */
@@ -0,0 +1,197 @@
+/**********************************************************************/
+/*           Compiled-code simulation kernels                         */
+/*                                                                    */
+/*           straight-line C++ generated from the compiled netlist,   */
+/*           built with the local compiler and loaded with dlopen     */
+/**********************************************************************/
+
+#include <dlfcn.h>
+#include <unistd.h>
+#include "atpg.h"
+
+/* With -compiled, the gates of the circuit are written out as C++, one
+ * pair of bitwise statements per gate on the rails of goodsim.cpp, and
+ * built into infile.so:
+ *   atpg_good_sim(one, zero)   every gate in sort_wlist order, replaces
+ *                              the loop of good_sim_block
+ *   atpg_evaluate(w, one, zero, new_one, new_zero)
+ *                              the gate driving wire w, replaces
+ *                              pattern_sim_evaluate (used by PPSFP)
+ * Neither does a switch on the gate type nor walks the fanin lists.
+ * infile.so records COMPILED_VERSION and a hash of the compiled netlist,
+ * and is rebuilt when either one differs.  The kernels use nothing from
+ * the C library, so they are built with -nostdlib and can be loaded by
+ * the static atpg binary.  The compiler is $CXX, or g++. */
+
+#define COMPILED_VERSION 1
+
+/* gates per generated function */
+#define num_of_chunk_gate 1024
+
+/* load infile.so, compiling it first if it is missing or out of date.
+ * return false, and keep the interpreted engines, if that fails */
+bool ATPG::load_compiled_sim(void) {
+  string so, src, tmpname, cmd;
+  const char *cxx;
+  uint64_t hash;
+
+  if (!use_compiled_sim) return false;
+  hash = hash_netlist();
+  so = filename + ".so";
+  if (open_compiled_sim(so, hash)) return true;
+
+  /* build into a temporary file and rename it,
+   * so that a concurrent run never loads a partial kernel */
+  src = filename + ".sim.cpp";
+  tmpname = so + "." + to_string(getpid());
+  cxx = getenv("CXX");
+  if (cxx == nullptr) cxx = "g++";
+  cmd = string(cxx) + " -O1 -shared -fPIC -nostdlib -o '" + tmpname + "' '" + src + "'";
+  if (!write_compiled_source(src, hash) || (system(cmd.c_str()) != 0) ||
+      (rename(tmpname.c_str(), so.c_str()) != 0)) {
+    remove(tmpname.c_str());
+    fprintf(stderr,"atpg: cannot build %s, the simulation is interpreted\n",so.c_str());
+    return false;
+  }
+  remove(src.c_str());
+  if (!open_compiled_sim(so, hash)) {
+    fprintf(stderr,"atpg: cannot load %s, the simulation is interpreted\n",so.c_str());
+    return false;
+  }
+  return true;
+}/* end of load_compiled_sim */
+
+/* 64-bit FNV-1a hash of the compiled netlist: gate types and fanin lists */
+uint64_t ATPG::hash_netlist(void) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  auto add = [&](const vector<int>& v) {
+    for (int x: v) {
+      hash ^= (uint32_t) x;
+      hash *= 0x100000001b3ULL;
+    }
+  };
+
+  add(gate_type);
+  add(fanin_start);
+  add(fanin_index);
+  return hash;
+}/* end of hash_netlist */
+
+/* dlopen so and take its kernels, if it was built for this netlist */
+bool ATPG::open_compiled_sim(const string& so, const uint64_t& hash) {
+  void *handle;
+  const int *version;
+  const uint64_t *netlist_hash;
+
+  if (access(so.c_str(), R_OK) != 0) return false;
+  handle = dlopen(so.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (handle == nullptr) return false;
+  version = (const int *) dlsym(handle, "atpg_compiled_version");
+  netlist_hash = (const uint64_t *) dlsym(handle, "atpg_netlist_hash");
+  compiled_good_sim = (void (*)(uint64_t*, uint64_t*)) dlsym(handle, "atpg_good_sim");
+  compiled_evaluate = (void (*)(int, const uint64_t*, const uint64_t*, uint64_t*, uint64_t*))
+                      dlsym(handle, "atpg_evaluate");
+  if ((version == nullptr) || (*version != COMPILED_VERSION) ||
+      (netlist_hash == nullptr) || (*netlist_hash != hash) ||
+      (compiled_good_sim == nullptr) || (compiled_evaluate == nullptr)) {
+    compiled_good_sim = nullptr;
+    compiled_evaluate = nullptr;
+    dlclose(handle);
+    return false;
+  }
+  compiled_handle = handle;
+  return true;
+}/* end of open_compiled_sim */
+
+/* write the kernels of the circuit to src.  the statements follow the
+ * cases of pattern_sim_evaluate: a NAND is an AND with its rails swapped */
+bool ATPG::write_compiled_source(const string& src, const uint64_t& hash) {
+  FILE *file;
+  int i, j, k, first, last, nckt, a, b;
+  bool and_like, ok;
+  vector<string> one, zero;   // the two rail expressions of every gate
+
+  nckt = sort_wlist.size();
+  one.assign(nckt, "");
+  zero.assign(nckt, "");
+  for (i = cktin.size(); i < nckt; i++) {
+    a = fanin_index[fanin_start[i]];
+    switch (gate_type[i]) {
+      case AND:
+      case BUF:
+      case NAND:
+      case OR:
+      case NOR:
+        /* an AND is one when all inputs are one and zero when any is zero */
+        and_like = (gate_type[i] != OR) && (gate_type[i] != NOR);
+        one[i] = "one[" + to_string(a) + "]";
+        zero[i] = "zero[" + to_string(a) + "]";
+        for (j = fanin_start[i] + 1; j < fanin_start[i + 1]; j++) {
+          one[i] += (and_like ? " & one[" : " | one[") + to_string(fanin_index[j]) + "]";
+          zero[i] += (and_like ? " | zero[" : " & zero[") + to_string(fanin_index[j]) + "]";
+        }
+        if ((gate_type[i] == NAND) || (gate_type[i] == NOR)) swap(one[i], zero[i]);
+        break;
+
+      case NOT:
+        one[i] = "zero[" + to_string(a) + "]";
+        zero[i] = "one[" + to_string(a) + "]";
+        break;
+
+      case XOR:
+      case EQV:
+        b = fanin_index[fanin_start[i] + 1];
+        one[i] = "(one[" + to_string(a) + "] & zero[" + to_string(b) + "]) | (zero[" +
+                 to_string(a) + "] & one[" + to_string(b) + "])";
+        zero[i] = "(one[" + to_string(a) + "] & one[" + to_string(b) + "]) | (zero[" +
+                  to_string(a) + "] & zero[" + to_string(b) + "])";
+        if (gate_type[i] == EQV) swap(one[i], zero[i]);
+        break;
+
+      default:
+        return false;
+    }
+  }
+
+  file = fopen(src.c_str(), "w");
+  if (file == nullptr) return false;
+  fprintf(file, "/* simulation kernels of %s, generated by atpg -compiled */\n\n", filename.c_str());
+  fprintf(file, "typedef unsigned long long word;\n\n");
+  fprintf(file, "extern \"C\" const int atpg_compiled_version = %d;\n", COMPILED_VERSION);
+  fprintf(file, "extern \"C\" const word atpg_netlist_hash = 0x%016llxULL;\n\n", (unsigned long long) hash);
+
+  /* the gates go to functions of num_of_chunk_gate gates each;
+   * one function of a whole large circuit takes the compiler too long */
+  for (k = cktin.size() / num_of_chunk_gate; k * num_of_chunk_gate < nckt; k++) {
+    first = max((int) cktin.size(), k * num_of_chunk_gate);
+    last = min(nckt, (k + 1) * num_of_chunk_gate);
+    fprintf(file, "static void good_sim_%d(word *one, word *zero) {\n", k);
+    for (i = first; i < last; i++) {
+      fprintf(file, "  one[%d] = %s;\n  zero[%d] = %s;\n", i, one[i].c_str(), i, zero[i].c_str());
+    }
+    fprintf(file, "}\n\n");
+    fprintf(file, "static void evaluate_%d(int w, const word *one, const word *zero, word *new_one, word *new_zero) {\n", k);
+    fprintf(file, "  switch (w) {\n");
+    for (i = first; i < last; i++) {
+      fprintf(file, "    case %d: *new_one = %s; *new_zero = %s; return;\n", i, one[i].c_str(), zero[i].c_str());
+    }
+    fprintf(file, "  }\n}\n\n");
+  }
+
+  fprintf(file, "extern \"C\" void atpg_good_sim(word *one, word *zero) {\n");
+  for (k = cktin.size() / num_of_chunk_gate; k * num_of_chunk_gate < nckt; k++) {
+    fprintf(file, "  good_sim_%d(one, zero);\n", k);
+  }
+  fprintf(file, "}\n\n");
+
+  fprintf(file, "extern \"C\" void atpg_evaluate(int w, const word *one, const word *zero,\n");
+  fprintf(file, "                              word *new_one, word *new_zero) {\n");
+  fprintf(file, "  switch (w / %d) {\n", num_of_chunk_gate);
+  for (k = cktin.size() / num_of_chunk_gate; k * num_of_chunk_gate < nckt; k++) {
+    fprintf(file, "    case %d: evaluate_%d(w, one, zero, new_one, new_zero); return;\n", k, k);
+  }
+  fprintf(file, "  }\n}\n");
+  ok = !ferror(file);
+  ok = (fclose(file) == 0) && ok;
+  return ok;
+}/* end of write_compiled_source */
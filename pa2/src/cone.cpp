@@ -0,0 +1,132 @@
+/**********************************************************************/
+/*           Fanout cones of the wires, for podem                     */
+/*                                                                    */
+/*           fanout-free regions and interval lists of the stems      */
+/**********************************************************************/
+
+#include "atpg.h"
+
+/* podem restricts the D-frontier to the fanout cone of the fault site.  The
+ * cones are computed once, on the compiled netlist:
+ *
+ * - a wire with exactly one fanout (and not a PO) is not a stem.  Following
+ *   the single fanout from a non-stem wire leads to a stem, cone_root[i].
+ *   These chains form one tree per stem (a fanout-free region), numbered in
+ *   DFS order: ffr_enter[i] .. ffr_leave[i] is the subtree of wire i.
+ * - the cone of a stem r is kept as sorted, disjoint [first, last] intervals
+ *   of wlist_index, cone_interval[cone_start[r] .. cone_start[r+1]).
+ *   Neighbouring wires are often in the same cone, so most cones take a
+ *   few intervals.
+ *
+ * The cone of any wire s is then the path from s to cone_root[s] in its
+ * tree, plus the cone of cone_root[s]; see in_fanout_cone. */
+void ATPG::compute_fanout_cones(void) {
+  int i, j, k, nckt, cursor, num_of_root;
+  vector<int> subtree_size;
+  vector<pair<int, int> > cone;    // intervals of the stem being computed
+
+  nckt = sort_wlist.size();
+  cone_root.assign(nckt, 0);
+  ffr_enter.assign(nckt, 0);
+  ffr_leave.assign(nckt, 0);
+  subtree_size.assign(nckt, 1);
+
+  /* the stems, from the POs back to the PIs */
+  for (i = nckt - 1; i >= 0; i--) {
+    if (is_fanout_stem(i)) cone_root[i] = i;
+    else cone_root[i] = cone_root[fanout_index[fanout_start[i]]];
+  }
+
+  /* DFS numbering of the trees: sizes bottom up, ranges top down */
+  for (i = 0; i < nckt; i++) {
+    if (!is_fanout_stem(i)) subtree_size[fanout_index[fanout_start[i]]] += subtree_size[i];
+  }
+  num_of_root = 0;
+  for (i = nckt - 1; i >= 0; i--) {
+    if (is_fanout_stem(i)) {
+      ffr_enter[i] = num_of_root;
+      num_of_root += subtree_size[i];
+    }
+    ffr_leave[i] = ffr_enter[i] + subtree_size[i];
+    cursor = ffr_enter[i] + 1;
+    for (k = fanin_start[i]; k < fanin_start[i + 1]; k++) {
+      j = fanin_index[k];
+      if (is_fanout_stem(j) || (fanout_index[fanout_start[j]] != i)) continue;
+      ffr_enter[j] = cursor;
+      cursor += subtree_size[j];
+    }
+  }
+
+  /* the cones of the stems, from the POs back, so that the cones of the
+   * stems in the fanout are known */
+  cone_start.assign(nckt + 1, 0);
+  cone_interval.clear();
+  vector<int> first_interval(nckt, 0), num_of_interval(nckt, 0);
+  vector<int> visited(nckt, -1);  // the stem whose cone last took the wire
+  for (i = nckt - 1; i >= 0; i--) {
+    if (!is_fanout_stem(i)) continue;
+    cone.clear();
+    cone.push_back(make_pair(i, i));
+    for (k = fanout_start[i]; k < fanout_start[i + 1]; k++) {
+      /* the chain up to the next stem, then the cone of that stem.  the
+       * chains of the fanouts merge, so stop where an earlier one went */
+      for (j = fanout_index[k]; visited[j] != i; j = fanout_index[fanout_start[j]]) {
+        visited[j] = i;
+        if (is_fanout_stem(j)) {
+          cone.insert(cone.end(), cone_interval.begin() + first_interval[j],
+                      cone_interval.begin() + first_interval[j] + num_of_interval[j]);
+          break;
+        }
+        cone.push_back(make_pair(j, j));
+      }
+    }
+    sort(cone.begin(), cone.end());
+    first_interval[i] = cone_interval.size();
+    for (auto& iv: cone) {
+      if ((cone_interval.size() > first_interval[i]) && (iv.first <= cone_interval.back().second + 1)) {
+        cone_interval.back().second = max(cone_interval.back().second, iv.second);
+      }
+      else {
+        cone_interval.push_back(iv);
+      }
+    }
+    num_of_interval[i] = cone_interval.size() - first_interval[i];
+  }
+
+  /* index the intervals by stem, in wlist_index order */
+  vector<pair<int, int> > by_stem;
+  by_stem.reserve(cone_interval.size());
+  for (i = 0; i < nckt; i++) {
+    cone_start[i] = by_stem.size();
+    by_stem.insert(by_stem.end(), cone_interval.begin() + first_interval[i],
+                   cone_interval.begin() + first_interval[i] + num_of_interval[i]);
+  }
+  cone_start[nckt] = by_stem.size();
+  cone_interval.swap(by_stem);
+}/* end of compute_fanout_cones */
+
+/* a stem is a wire that does not have exactly one fanout, or a PO */
+bool ATPG::is_fanout_stem(const int& w_index) {
+  return((fanout_start[w_index + 1] - fanout_start[w_index] != 1) ||
+         (sort_wlist[w_index]->flag & OUTPUT));
+}/* end of is_fanout_stem */
+
+/* true if wire w_index is in the fanout cone of wire s (s included) */
+bool ATPG::in_fanout_cone(const int& s, const int& w_index) {
+  int r, lo, hi, mid;
+
+  /* on the path from s to its stem */
+  if ((ffr_enter[w_index] <= ffr_enter[s]) && (ffr_enter[s] < ffr_leave[w_index])) return(true);
+
+  /* in the cone of the stem: binary search of the last interval starting
+   * at or before w_index */
+  r = cone_root[s];
+  lo = cone_start[r];
+  hi = cone_start[r + 1] - 1;
+  while (lo < hi) {
+    mid = (lo + hi + 1) / 2;
+    if (cone_interval[mid].first <= w_index) lo = mid;
+    else hi = mid - 1;
+  }
+  return((cone_interval[lo].first <= w_index) && (w_index <= cone_interval[lo].second));
+}/* end of in_fanout_cone */
@@ -22,16 +22,22 @@ void ATPG::fault_simulate_vectors(int& total_detect_num) {
   int i;
   int current_detect_num = 0;
  
+  /* parallel-pattern single-fault propagation, see ppsfp.cpp */
+  if (ppsfp) {
+    fault_simulate_vectors_ppsfp(total_detect_num);
+    return;
+  }
+
   /* for every vector */
-  for (i = vectors.size()-1; i >= 0; i--) {
-    fault_sim_a_vector(vectors[i], current_detect_num);
+  for (i = patterns.size()-1; i >= 0; i--) {
+    fault_sim_a_vector(i, current_detect_num);
     total_detect_num += current_detect_num;
     fprintf(stdout,"vector[%d] detects %d faults (%d)\n",i,current_detect_num,total_detect_num);
   }
 }// fault_simulate_vectors
 
 /* fault simulate a single test vector */
-void ATPG::fault_sim_a_vector(const string& vec, int& num_of_current_detect) {
+void ATPG::fault_sim_a_vector(const int& p, int& num_of_current_detect) {
   wptr w,faulty_wire;
   /* array of 16 fptrs, which points to the 16 faults in a simulation packet  */
   fptr simulated_fault_list[num_of_pattern];
@@ -40,6 +46,11 @@ void ATPG::fault_sim_a_vector(const string& vec, int& num_of_current_detect) {
   int i,start_wire_index, nckt;
   int num_of_fault;
   
+  /* wider packets and threads are handled by the dual-rail engine, see faultsim64.cpp */
+  if ((packet_size != num_of_pattern) || (num_of_threads > 1)) {
+    fault_sim_a_vector64(p, num_of_current_detect);
+    return;
+  }
   
   num_of_fault = 0; // counts the number of faults in a packet
 
@@ -55,7 +66,7 @@ void ATPG::fault_sim_a_vector(const string& vec, int& num_of_current_detect) {
   
   /* for every input, set its value to the current vector value */
   for(i = 0; i < cktin.size(); i++) {
-    cktin[i]->value = ctoi(vec[i]);
+    cktin[i]->value = patterns.get(p, i);
   }
 
   /* initialize the circuit - mark all inputs as changed and all other
@@ -77,12 +88,12 @@ void ATPG::fault_sim_a_vector(const string& vec, int& num_of_current_detect) {
    * and store it in wire_value1 (good value) and wire_value2 (faulty value)*/
   for (i = 0; i < nckt; i++) {
     switch (sort_wlist[i]->value) {
-    case 1: sort_wlist[i]->wire_value1 = ALL_ONE;  // 11 represents logic one
-            sort_wlist[i]->wire_value2 = ALL_ONE; break;
-    case 2: sort_wlist[i]->wire_value1 = 0x55555555; // 01 represents unknown
-            sort_wlist[i]->wire_value2 = 0x55555555; break;
-    case 0: sort_wlist[i]->wire_value1 = ALL_ZERO; // 00 represents logic zero
-            sort_wlist[i]->wire_value2 = ALL_ZERO; break;
+    case 1: wire_value1[i] = ALL_ONE;  // 11 represents logic one
+            wire_value2[i] = ALL_ONE; break;
+    case 2: wire_value1[i] = 0x55555555; // 01 represents unknown
+            wire_value2[i] = 0x55555555; break;
+    case 0: wire_value1[i] = ALL_ZERO; // 00 represents logic zero
+            wire_value2[i] = ALL_ZERO; break;
     }
   } // for i
 
@@ -121,8 +132,8 @@ void ATPG::fault_sim_a_vector(const string& vec, int& num_of_current_detect) {
 	        /* mark the wire as having a fault injected 
 	         * and schedule the outputs of this gate */
           sort_wlist[f->to_swlist]->flag |= FAULT_INJECTED;
-          for (auto pos_n = sort_wlist[f->to_swlist]->onode.cbegin(), end_n = sort_wlist[f->to_swlist]->onode.cend(); pos_n != end_n; ++pos_n) {
-            (*pos_n)->owire.front()->flag |= SCHEDULED;
+          for (i = fanout_start[f->to_swlist]; i < fanout_start[f->to_swlist + 1]; i++) {
+            sort_wlist[fanout_index[i]]->flag |= SCHEDULED;
           }
 	    
           /* increment the number of simulated faults in this packet */
@@ -159,8 +170,8 @@ void ATPG::fault_sim_a_vector(const string& vec, int& num_of_current_detect) {
 		          /* mark the faulty_wire as having a fault injected 
 		           *  and schedule the outputs of this gate */
 		          faulty_wire->flag |= FAULT_INJECTED;
-              for (auto pos_n = faulty_wire->onode.cbegin(), end_n = faulty_wire->onode.cend(); pos_n != end_n; ++pos_n) {
-                (*pos_n)->owire.front()->flag |= SCHEDULED;
+              for (i = fanout_start[faulty_wire->wlist_index]; i < fanout_start[faulty_wire->wlist_index + 1]; i++) {
+                sort_wlist[fanout_index[i]]->flag |= SCHEDULED;
               }
 		   
               num_of_fault++;
@@ -186,7 +197,7 @@ void ATPG::fault_sim_a_vector(const string& vec, int& num_of_current_detect) {
 	    for (i = start_wire_index; i < nckt; i++) {
 	      if (sort_wlist[i]->flag & SCHEDULED) {
 	      sort_wlist[i]->flag &= ~SCHEDULED;
-	      fault_sim_evaluate(sort_wlist[i]);
+	      fault_sim_evaluate(i);
 	      }
 	    } /* event evaluations end here */
 	  
@@ -202,24 +213,24 @@ void ATPG::fault_sim_a_vector(const string& vec, int& num_of_current_detect) {
 	      //printf("before : %d\n", w->flag);
 	      w->flag &= ~FAULTY;
 	      w->flag &= ~FAULT_INJECTED;
-	      w->fault_flag &= ALL_ZERO;
+	      fault_flag[w->wlist_index] &= ALL_ZERO;
 	      //printf("after  : %d\n", w->flag);
         /*TODO*/
         //Hint:Use mask to get the value of faulty wire and check every fault in packet
 	      if (w->flag & OUTPUT) { // if primary output 
           for (i = 0; i < num_of_fault; i++) { // check every undetected fault
             if (!(simulated_fault_list[i]->detect)) {
-              if ((w->wire_value2 & Mask[i]) ^    // if value1 != value2
-                  (w->wire_value1 & Mask[i])) {
-                if (((w->wire_value2 & Mask[i]) ^ Unknown[i])&&  // and not unknowns
-                    ((w->wire_value1 & Mask[i]) ^ Unknown[i])){
+              if ((wire_value2[w->wlist_index] & Mask[i]) ^    // if value1 != value2
+                  (wire_value1[w->wlist_index] & Mask[i])) {
+                if (((wire_value2[w->wlist_index] & Mask[i]) ^ Unknown[i])&&  // and not unknowns
+                    ((wire_value1[w->wlist_index] & Mask[i]) ^ Unknown[i])){
                       simulated_fault_list[i]->detect = TRUE;  // then the fault is detected
                 }
               }
             }
           }
 	      }
-	      w->wire_value2 = w->wire_value1;  // reset to fault-free values
+	      wire_value2[w->wlist_index] = wire_value1[w->wlist_index];  // reset to fault-free values
         /*TODO*/
 	    } // pop out all faulty wires
     num_of_fault = 0;  // reset the counter of faults in a packet
@@ -240,27 +251,26 @@ void ATPG::fault_sim_a_vector(const string& vec, int& num_of_current_detect) {
     });
 }/* end of fault_sim_a_vector */
 
-/* evaluate wire w 
- * 1. update w->wire_value2 
+/* evaluate wire w_index on the compiled netlist
+ * 1. update wire_value2[w_index]
  * 2. schedule new events if value2 != value1 */
-void ATPG::fault_sim_evaluate(const wptr w) {
+void ATPG::fault_sim_evaluate(const int& w_index) {
   unsigned int new_value;
-  nptr n;
-  int i, nin, nout;
+  wptr w;
+  int i, begin, end;
 
-  /*if (w->flag & INPUT) return;*/
-  n = w->inode.front();
-  nin = n->iwire.size();
-  switch(n->type) {
+  begin = fanin_start[w_index];
+  end = fanin_start[w_index + 1];
+  switch(gate_type[w_index]) {
      /*break a multiple-input gate into multiple two-input gates */
     case AND:
     case BUF:
     case NAND:
       new_value = ALL_ONE;
-      for (i = 0; i < nin; i++) {
-        new_value &= n->iwire[i]->wire_value2;
+      for (i = begin; i < end; i++) {
+        new_value &= wire_value2[fanin_index[i]];
       }
-      if (n->type == NAND) {
+      if (gate_type[w_index] == NAND) {
 	    new_value = PINV(new_value);  // PINV is for three-valued inversion
       }
       break;
@@ -268,38 +278,39 @@ void ATPG::fault_sim_evaluate(const wptr w) {
     case OR:
     case NOR:
       new_value = ALL_ZERO;
-      for (i = 0; i < nin; i++) {
-        new_value |= n->iwire[i]->wire_value2;
+      for (i = begin; i < end; i++) {
+        new_value |= wire_value2[fanin_index[i]];
       }
-      if (n->type == NOR) {
+      if (gate_type[w_index] == NOR) {
         new_value = PINV(new_value);
       }
       break;
 
     case NOT:
-      new_value = PINV(n->iwire.front()->wire_value2);
+      new_value = PINV(wire_value2[fanin_index[begin]]);
       break;
 
     case XOR:
-      new_value = PEXOR(n->iwire[0]->wire_value2, n->iwire[1]->wire_value2);
+      new_value = PEXOR(wire_value2[fanin_index[begin]], wire_value2[fanin_index[begin + 1]]);
       break;
 
     case EQV:
-      new_value = PEQUIV(n->iwire[0]->wire_value2, n->iwire[1]->wire_value2);
+      new_value = PEQUIV(wire_value2[fanin_index[begin]], wire_value2[fanin_index[begin + 1]]);
       break;
   }
 
   /* if the new_value is different than the wire_value1 (the good value),
    * save it */
-  if (w->wire_value1 != new_value) {
+  if (wire_value1[w_index] != new_value) {
+    w = sort_wlist[w_index];
 
     /* if this wire is faulty, make sure the fault remains injected */
     if (w->flag & FAULT_INJECTED) {
-      combine(w, new_value);
+      combine(w_index, new_value);
     }
 
     /* update wire_value2 */ 
-    w->wire_value2 = new_value;
+    wire_value2[w_index] = new_value;
 
     /* insert wire w into the faulty_wire list */
     if (!(w->flag & FAULTY)) {
@@ -308,10 +319,8 @@ void ATPG::fault_sim_evaluate(const wptr w) {
     }
 
     /* schedule new events */
-    for (i = 0, nout = w->onode.size(); i < nout; i++) {
-      if (w->onode[i]->type != OUTPUT) {
-        w->onode[i]->owire.front()->flag |= SCHEDULED;
-      }
+    for (i = fanout_start[w_index]; i < fanout_start[w_index + 1]; i++) {
+      sort_wlist[fanout_index[i]]->flag |= SCHEDULED;
     }
   } // if new_value is differnt
   // if new_value is the same as the good value, do not schedule any new event
@@ -419,22 +428,22 @@ ATPG::wptr ATPG::get_faulty_wire(const fptr f, int& fault_type) {
 void ATPG::inject_fault_value(const wptr faulty_wire, const int& bit_position, const int& fault_type) {
   /*TODO*/
   //Hint use mask to inject fault to the right position
-  if (fault_type == STUCK1) faulty_wire->wire_value2 |= Mask[bit_position];// SA1 fault
-  if (fault_type == STUCK0) faulty_wire->wire_value2 &= ~Mask[bit_position]; // SA0 fault
-  faulty_wire->fault_flag |= Mask[bit_position];// bit position of the fault 
+  if (fault_type == STUCK1) wire_value2[faulty_wire->wlist_index] |= Mask[bit_position];// SA1 fault
+  if (fault_type == STUCK0) wire_value2[faulty_wire->wlist_index] &= ~Mask[bit_position]; // SA0 fault
+  fault_flag[faulty_wire->wlist_index] |= Mask[bit_position];// bit position of the fault 
   /*TODO*/
 }/* end of inject_fault_value */
 
 /* For each fault in this packet, check
  * if wire w itself is the fault site, do not change its wire_value2.
  * (because the wire_value2 was already decided by the inject_fault_value fucntion) */
-void ATPG::combine(const wptr w, unsigned int& new_value) {
+void ATPG::combine(const int& w_index, unsigned int& new_value) {
   int i;
   
   for (i = 0; i < num_of_pattern; i++) {
-    if (w->fault_flag & Mask[i]) {
+    if (fault_flag[w_index] & Mask[i]) {
       new_value &= ~Mask[i];
-      new_value |= (w->wire_value2 & Mask[i]);
+      new_value |= (wire_value2[w_index] & Mask[i]);
     }
   }
   return;
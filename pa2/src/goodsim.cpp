@@ -0,0 +1,159 @@
+/**********************************************************************/
+/*           Pattern-Parallel Good Machine Simulator                  */
+/*                                                                    */
+/*           64 patterns per pass, one bit per pattern in each rail   */
+/**********************************************************************/
+
+#include "atpg.h"
+
+/* pack 64 patterns into one block */
+#define num_of_block_pattern 64
+
+/* The fault-free value of a wire under 64 patterns is kept in two rails:
+ *   pattern_good_one  : bit b set if the wire is logic one  under pattern first + b
+ *   pattern_good_zero : bit b set if the wire is logic zero under pattern first + b
+ * Neither bit is set for an unknown.  good_sim_block evaluates every gate
+ * once per block, in sort_wlist order, on the compiled netlist.  It is the
+ * good machine of the PPSFP fault simulator (ppsfp.cpp) and of -gsim. */
+
+/* good machine simulate the patterns and print the PO response of every
+ * pattern, followed by the switching activity of the pattern set */
+void ATPG::good_simulate_vectors(void) {
+  int first, num, b, i, nckt, ncktin;
+  uint64_t one, zero, toggle;
+  uint64_t num_of_toggle = 0;   // changes of a known value between consecutive patterns
+  vector<uint64_t> last_one, last_zero;   // the last pattern of the previous block
+  string line;
+
+  nckt = sort_wlist.size();
+  ncktin = cktin.size();
+  last_one.assign(nckt, ALL_ZERO64);
+  last_zero.assign(nckt, ALL_ZERO64);
+
+  for (first = 0; first < patterns.size(); first += num) {
+    num = min(num_of_block_pattern, patterns.size() - first);
+    good_sim_block(first, num);
+
+    /* PO response of every pattern of the block */
+    for (b = 0; b < num; b++) {
+      line = "T\'";
+      for (i = 0; i < ncktin; i++) {
+        line.push_back((pattern_good_one[i] >> b & 1) ? '1' : (pattern_good_zero[i] >> b & 1) ? '0' : 'x');
+      }
+      line += "\' ";
+      for (wptr w: cktout) {
+        i = w->wlist_index;
+        line.push_back((pattern_good_one[i] >> b & 1) ? '1' : (pattern_good_zero[i] >> b & 1) ? '0' : 'x');
+      }
+      line.push_back('\n');
+      fputs(line.c_str(), stdout);
+    }
+
+    /* bit b of toggle: the wire goes from 0 to 1 or from 1 to 0
+     * between pattern first + b - 1 and pattern first + b */
+    for (i = 0; i < nckt; i++) {
+      one = pattern_good_one[i];
+      zero = pattern_good_zero[i];
+      toggle = ((one << 1) | last_one[i]) & zero;
+      toggle |= ((zero << 1) | last_zero[i]) & one;
+      num_of_toggle += __builtin_popcountll(toggle);
+      last_one[i] = one >> (num_of_block_pattern - 1);
+      last_zero[i] = zero >> (num_of_block_pattern - 1);
+    }
+  }
+
+  fprintf(stdout, "\n# Good machine simulation:\n");
+  fprintf(stdout, "-----------------------\n");
+  fprintf(stdout, "# number of vectors: %d\n", patterns.size());
+  fprintf(stdout, "# number of toggles: %llu\n", (unsigned long long) num_of_toggle);
+  if ((patterns.size() > 1) && (nckt > 0)) {
+    fprintf(stdout, "# switching activity: %f toggles per wire per vector\n",
+            (double) num_of_toggle / ((double) nckt * (patterns.size() - 1)));
+  }
+}/* end of good_simulate_vectors */
+
+/* load patterns [first, first + num) into the PI rails, num <= 64,
+ * and evaluate the fault-free circuit for all of them at once */
+void ATPG::good_sim_block(const int& first, const int& num) {
+  int i, b, nckt, ncktin;
+
+  nckt = sort_wlist.size();
+  ncktin = cktin.size();
+  if (pattern_good_one.size() != nckt) {
+    pattern_good_one.assign(nckt, ALL_ZERO64);
+    pattern_good_zero.assign(nckt, ALL_ZERO64);
+  }
+
+  for (i = 0; i < ncktin; i++) {
+    pattern_good_one[i] = ALL_ZERO64;
+    pattern_good_zero[i] = ALL_ZERO64;
+    for (b = 0; b < num; b++) {
+      switch (patterns.get(first + b, i)) {
+        case 1: pattern_good_one[i] |= 1ULL << b; break;
+        case 0: pattern_good_zero[i] |= 1ULL << b; break;
+      }
+    }
+  }
+
+  /* evaluate every gate once in level order */
+  if (compiled_good_sim != nullptr) { // code compiled for this circuit, see compiled.cpp
+    compiled_good_sim(pattern_good_one.data(), pattern_good_zero.data());
+    return;
+  }
+  for (i = ncktin; i < nckt; i++) {
+    pattern_sim_evaluate(i, pattern_good_one, pattern_good_zero,
+                         pattern_good_one[i], pattern_good_zero[i]);
+  }
+}/* end of good_sim_block */
+
+/* evaluate the gate driving wire w_index on the rails (one, zero), 64 patterns at once */
+void ATPG::pattern_sim_evaluate(const int& w_index, const vector<uint64_t>& one, const vector<uint64_t>& zero,
+                                uint64_t& new_one, uint64_t& new_zero) {
+  int i, begin, end, a, b;
+
+  if (compiled_evaluate != nullptr) { // code compiled for this circuit, see compiled.cpp
+    compiled_evaluate(w_index, one.data(), zero.data(), &new_one, &new_zero);
+    return;
+  }
+
+  begin = fanin_start[w_index];
+  end = fanin_start[w_index + 1];
+  switch(gate_type[w_index]) {
+    case AND:
+    case BUF:
+    case NAND:
+      new_one = ALL_ONE64;
+      new_zero = ALL_ZERO64;
+      for (i = begin; i < end; i++) {
+        new_one &= one[fanin_index[i]];
+        new_zero |= zero[fanin_index[i]];
+      }
+      if (gate_type[w_index] == NAND) swap(new_one, new_zero);
+      break;
+
+    case OR:
+    case NOR:
+      new_one = ALL_ZERO64;
+      new_zero = ALL_ONE64;
+      for (i = begin; i < end; i++) {
+        new_one |= one[fanin_index[i]];
+        new_zero &= zero[fanin_index[i]];
+      }
+      if (gate_type[w_index] == NOR) swap(new_one, new_zero);
+      break;
+
+    case NOT:
+      new_one = zero[fanin_index[begin]];
+      new_zero = one[fanin_index[begin]];
+      break;
+
+    case XOR:
+    case EQV:
+      a = fanin_index[begin];
+      b = fanin_index[begin + 1];
+      new_one = (one[a] & zero[b]) | (zero[a] & one[b]);
+      new_zero = (one[a] & one[b]) | (zero[a] & zero[b]);
+      if (gate_type[w_index] == EQV) swap(new_one, new_zero);
+      break;
+  }
+}/* end of pattern_sim_evaluate */
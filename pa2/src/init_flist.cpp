@@ -15,7 +15,7 @@ void ATPG::generate_fault_list(void) {
   int fault_num;
   wptr w;
   nptr n;
-  fptr_s f;
+  fptr f;
   
   /* walk through every wire in the circuit*/
   for (auto pos = sort_wlist.crbegin(); pos != sort_wlist.crend(); ++pos) {
@@ -23,8 +23,7 @@ void ATPG::generate_fault_list(void) {
     n = w->inode.front();
     
     /* for each gate, create a gate output stuck-at zero (SA0) fault */
-    f = move(fptr_s(new(nothrow) FAULT));
-    if (f == nullptr) error("No more room!");
+    f = fault_pool.create();
     f->node = n;
     f->io = GO;
     f->fault_type = STUCK0;
@@ -47,12 +46,11 @@ void ATPG::generate_fault_list(void) {
       case   XOR: f->eqv_fault_num = 1; break;
     }
     num_of_gate_fault += f->eqv_fault_num; // accumulate total fault count
-    flist_undetect.push_front(f.get()); // initial undetected fault list contains all faults
-    flist.push_front(move(f));  // push into the fault list
+    flist_undetect.push_front(f); // initial undetected fault list contains all faults
+    flist.push_front(f);  // push into the fault list
     
     /* for each gate, create a gate output stuck-at one (SA1) fault */
-    f = move(fptr_s(new(nothrow) FAULT));
-    if (f == nullptr) error("No more room!");
+    f = fault_pool.create();
     f->node = n;
     f->io = GO;
     f->fault_type = STUCK1;
@@ -75,8 +73,8 @@ void ATPG::generate_fault_list(void) {
       case   XOR: f->eqv_fault_num = 1; break;
     }
     num_of_gate_fault += f->eqv_fault_num;
-    flist_undetect.push_front(f.get());
-    flist.push_front(move(f));
+    flist_undetect.push_front(f);
+    flist.push_front(f);
     /*if w has multiple fanout branches */
     if (w->onode.size() > 1) {
       for (nptr nptr_ele: w->onode) {
@@ -87,8 +85,7 @@ void ATPG::generate_fault_list(void) {
           case    NOR: 
           case    EQV:
           case    XOR:
-            f = move(fptr_s(new(nothrow) FAULT));
-            if (f == nullptr) error("No more room!");
+            f = fault_pool.create();
             f->node = nptr_ele;
             f->io = GI;
             f->fault_type = STUCK0;
@@ -100,8 +97,8 @@ void ATPG::generate_fault_list(void) {
               if (nptr_ele->iwire[k] == w) f->index = k;
             }
             num_of_gate_fault++;
-            flist_undetect.push_front(f.get());
-            flist.push_front(move(f));
+            flist_undetect.push_front(f);
+            flist.push_front(f);
             break;
         }
         /* create SA1 for AND NAND EQV XOR gate inputs  */
@@ -111,8 +108,7 @@ void ATPG::generate_fault_list(void) {
           case  NAND: 
           case   EQV:
           case   XOR:
-            f = move(fptr_s(new(nothrow) FAULT));
-            if (f == nullptr) error("No more room!");
+            f = fault_pool.create();
             f->node = nptr_ele;
             f->io = GI;
             f->fault_type = STUCK1;
@@ -122,8 +118,8 @@ void ATPG::generate_fault_list(void) {
               if (nptr_ele->iwire[k] == w) f->index = k;
             }
             num_of_gate_fault++;
-            flist_undetect.push_front(f.get());
-            flist.push_front(move(f));
+            flist_undetect.push_front(f);
+            flist.push_front(f);
             break;
         }
       }
@@ -155,7 +151,7 @@ void ATPG::compute_fault_coverage(void) {
   eqv_num_of_gate_fault = 0;
   
   for (auto pos = flist.cbegin(); pos != flist.cend(); ++pos) {
-    f = (*pos).get();
+    f = *pos;
     if (debug) {
       if (f->detect != 0) {
         switch (f->node->type) {
@@ -5,77 +5,130 @@
 /*           last update : 01/21/2018                                 */
 /**********************************************************************/
 
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "atpg.h"
 
-/* convert the name into integer to index the hashtable */
-int ATPG::hashcode(const string& name) {
-  int i = 0, j = 0;
-  
-  for (auto pos = name.cbegin(), end = name.cend(); (pos != end) && (j < 8); ++pos) {
-    i = i*10 + (*pos - '0');
-    ++j;
+/* The wires and the nodes are kept in wlist and nlist in the order of
+ * creation, which is the order of their first appearance in the circuit
+ * file.  The name tables map a name to its index in these lists; they only
+ * speed up the lookup and never decide an iteration order. */
+
+/* 64-bit FNV-1a hash of a name */
+uint64_t ATPG::NAME_TABLE::hash(const TOKEN& name) {
+  uint64_t h = 0xcbf29ce484222325ULL;
+  int i;
+
+  for (i = 0; i < name.len; i++) {
+    h ^= (unsigned char) name[i];
+    h *= 0x100000001b3ULL;
   }
-  
-  i = i%HASHSIZE;
-  return i<0 ? i + HASHSIZE : i;
-}/* end of hashcode */
+  return h;
+}/* end of hash */
+
+/* return the index stored for name, or -1 if name is not in the table */
+int ATPG::NAME_TABLE::find(const TOKEN& name) const {
+  uint64_t h;
+  size_t mask, slot;
+
+  if (index.empty()) return(-1);
+  h = hash(name);
+  mask = index.size() - 1;
+  /* linear probing, stops at the first free slot */
+  for (slot = h & mask; index[slot] >= 0; slot = (slot + 1) & mask) {
+    if ((code[slot] == h) && (key[slot] == name)) return(index[slot]);
+  }
+  return(-1);
+}/* end of find */
+
+/* add name with index i.  name is not copied, so the characters it points
+ * to must live as long as the table; the tables point to WIRE/NODE::name */
+void ATPG::NAME_TABLE::insert(const TOKEN& name, const int& i) {
+  uint64_t h;
+  size_t mask, slot;
+
+  /* keep the table at most half full */
+  if ((size_t) 2 * (num_of_entry + 1) > index.size()) grow();
+  h = hash(name);
+  mask = index.size() - 1;
+  for (slot = h & mask; index[slot] >= 0; slot = (slot + 1) & mask);
+  key[slot] = name;
+  code[slot] = h;
+  index[slot] = i;
+  num_of_entry++;
+}/* end of insert */
+
+/* double the number of slots and move the entries, the hashes are kept */
+void ATPG::NAME_TABLE::grow(void) {
+  vector<TOKEN> old_key;
+  vector<uint64_t> old_code;
+  vector<int> old_index;
+  size_t mask, slot, i;
+
+  old_key.swap(key);
+  old_code.swap(code);
+  old_index.swap(index);
+  i = max((size_t) 1024, 2 * old_index.size());
+  key.assign(i, TOKEN());
+  code.assign(i, 0);
+  index.assign(i, -1);
+
+  mask = index.size() - 1;
+  for (i = 0; i < old_index.size(); i++) {
+    if (old_index[i] < 0) continue;
+    for (slot = old_code[i] & mask; index[slot] >= 0; slot = (slot + 1) & mask);
+    key[slot] = old_key[i];
+    code[slot] = old_code[i];
+    index[slot] = old_index[i];
+  }
+}/* end of grow */
 
 /* wfind checks the existence of a wire
  * return the wire pointer if it exists; otherwise return a NULL pointer
  */
-ATPG::wptr ATPG::wfind(const string& name) {
-  int hash_idx = hashcode(name);
-  
-  /* search the forward_list at hast_nlist[code],
-     using iterator to visit the elements within the forward_list    */
-  for (auto pos = hash_wlist[hash_idx].cbegin(), end = hash_wlist[hash_idx].cend(); pos != end; ++pos) {
-    if (name == (*pos)->name) return (*pos).get(); // "return *pos" would return a unique_ptr obj, that's wrong.
-  }
-  return(nullptr);
+ATPG::wptr ATPG::wfind(const TOKEN& name) {
+  int i = wire_table.find(name);
+  return (i < 0) ? nullptr : wlist[i];
 }/* end of wfind */
 
 /* nfind checks the existence of a node
  * return the node pointer if it exists; otherwise return a NULL pointer
  */
-ATPG::nptr ATPG::nfind(const string& name) {
-  int hash_idx = hashcode(name);
-  
-  for (auto pos = hash_nlist[hash_idx].cbegin(), end = hash_nlist[hash_idx].cend(); pos != end; ++pos) {
-    if (name == (*pos)->name) return (*pos).get(); // "return *pos" would return a unique_ptr obj, that's wrong.
-  }
-  return(nullptr);
+ATPG::nptr ATPG::nfind(const TOKEN& name) {
+  int i = node_table.find(name);
+  return (i < 0) ? nullptr : nlist[i];
 }/* end of nfind */
 
 /* get wire obj and return the wire pointer */
-ATPG::wptr ATPG::getwire(const string& wirename) {
+ATPG::wptr ATPG::getwire(const TOKEN& wirename) {
   wptr w = wfind(wirename);
   if (w != nullptr) { return(w); }
   
-  /* allocate new wire from free storage */
-  wptr_s wtemp(new(nothrow) WIRE); 
-  if (wtemp == nullptr) { error("No more room!"); }
+  /* allocate new wire from the wire pool */
+  w = wire_pool.create();
   
   /* initialize wire entries */
-  wtemp->name = wirename;
-  int hash_no = hashcode(wirename);
-  hash_wlist[hash_no].push_front(move(wtemp)); // push into the hash table
-  return hash_wlist[hash_no].front().get();
+  w->name = wirename.to_string();
+  wire_table.insert(w->name, wlist.size()); // index the name
+  wlist.push_back(w);
+  return(w);
 }/* end of getwire */
 
 /* get node obj and return the node pointer */
-ATPG::nptr ATPG::getnode(const string& nodename) {
+ATPG::nptr ATPG::getnode(const TOKEN& nodename) {
   nptr n = nfind(nodename);
   if (n != nullptr) { return(n); }
   
-  /* allocate new node from free storage */
-  nptr_s ntemp(new(nothrow) NODE); 
-  if (ntemp == nullptr) { error("No more room!"); }
+  /* allocate new node from the node pool */
+  n = node_pool.create();
   
   /* initialize node entries */
-  ntemp->name = nodename;
-  int hash_no = hashcode(nodename);
-  hash_nlist[hash_no].push_front(move(ntemp)); // push into the hash table
-  return hash_nlist[hash_no].front().get();
+  n->name = nodename.to_string();
+  node_table.insert(n->name, nlist.size()); // index the name
+  nlist.push_back(n);
+  return(n);
 }/* end of getnode */
 
 /* new gate */
@@ -147,43 +200,58 @@ void ATPG::set_input(const bool& pori) {
   return;
 }/* end of set_input */
 
-/* parse input line into tokens, filling up targv and setting targc */
-void ATPG::parse_line(const string& line) {
-  for (int i = 0; i < 100; i++) {
-    targv[i].clear();
-  }
-  if(!line.empty()) {
-    targc = 1;
-    for (auto pos = line.begin(), end = line.end(); pos != end; ++pos) {
+/* parse the input line [line, eol) into tokens, filling up targv and setting targc.
+ * every character <= ' ' ends a token, so two adjacent blanks give an empty token.
+ * the tokens point into the line, nothing is copied */
+void ATPG::parse_line(const char *line, const char *eol) {
+  const char *begin;
+
+  targv.clear();
+  if (line != eol) {
+    begin = line;
+    for (const char *pos = line; pos != eol; ++pos) {
       if (*pos <= ' ') {
-        targc++;
-        continue;
+        targv.push_back(TOKEN(begin, pos - begin));
+        begin = pos + 1;
       }
-      targv[targc-1].push_back(*pos);
     }
+    targv.push_back(TOKEN(begin, eol - begin));
   }
-  else {
-    targc = 0;
-  }
+  targc = targv.size();
 }/* end of parse_line */
 
+/* the circuit file is mapped into memory and parsed in place, line by line */
 void ATPG::input(const string& infile) { 
-  string line;
+  int fd;
+  struct stat st;
+  size_t size;
+  const char *text, *line, *eol, *end;
+
   filename = infile;
-  ifstream file(filename, std::ifstream::in); // open the input vectors' file
-  if(!file) { // if the ifstream obj does not exist, fail to open the file
+  fd = open(filename.c_str(), O_RDONLY);
+  if ((fd < 0) || (fstat(fd, &st) != 0)) {
     fprintf(stderr,"Cannot open input file %s\n",filename.c_str());
     exit(EXIT_FAILURE);
   }
-  while(!file.eof() && !file.bad()) {
-    getline(file, line); // get a line from the file
-    lineno++;
-    parse_line(line);
-    //cout << targc << endl;
-    for (int i = 0; !targv[i].empty(); i++) {
-      //cout << "targv[" << i <<"]: " << targv[i] << endl;
+  size = st.st_size;
+  text = "";
+  if (size > 0) {
+    text = (const char *) mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (text == MAP_FAILED) {
+      fprintf(stderr,"Cannot open input file %s\n",filename.c_str());
+      exit(EXIT_FAILURE);
     }
-    if (targv[0].empty()) continue;
+  }
+  close(fd);
+
+  /* like getline, a file of n newlines has n+1 lines, the last one may be empty */
+  end = text + size;
+  for (line = text; line != nullptr; line = (eol == end) ? nullptr : eol + 1) {
+    eol = (const char *) memchr(line, '\n', end - line);
+    if (eol == nullptr) eol = end;
+    lineno++;
+    parse_line(line, eol);
+    if ((targc == 0) || targv[0].empty()) continue;
     if (targv[0] == "name") {
       if (targc != 2) {
         //cout << targc << endl;
@@ -212,15 +280,18 @@ void ATPG::input(const string& infile) {
     }
   }
   
-  int ncktnode = 0;
-  int ncktwire = 0;
-  for (int i = 0; i < HASHSIZE; i++) {
-    ncktnode += distance(hash_nlist[i].begin(), hash_nlist[i].end());
-    ncktwire += distance(hash_wlist[i].begin(), hash_wlist[i].end());
-  }
+  int ncktnode = nlist.size();
+  int ncktwire = wlist.size();
   
-  file.close();
+  if (size > 0) munmap((void *) text, size);
   create_structure();
+  num_input_node = ncktnode;
+  display_circuit_summary(ncktnode, ncktwire);
+  if (debug) display_circuit();
+  //display_circuit();
+}/* end of input */
+
+void ATPG::display_circuit_summary(const int& ncktnode, const int& ncktwire) {
   fprintf(stdout,"\n");
   fprintf(stdout,"#Circuit Summary:\n");
   fprintf(stdout,"#---------------\n");
@@ -228,31 +299,27 @@ void ATPG::input(const string& infile) {
   fprintf(stdout,"#number of outputs = %d\n",int(cktout.size()) );
   fprintf(stdout,"#number of gates = %d\n",ncktnode);
   fprintf(stdout,"#number of wires = %d\n",ncktwire);
-  if (debug) display_circuit();
-  //display_circuit();
-}/* end of input */
+}/* end of display_circuit_summary */
 
 void ATPG::create_structure(void) {
   nptr n;
   int i;
 
-  /*walk through every node in the circuit  */
-  for (i = 0; i < HASHSIZE; i++) {
-    for (auto pos = hash_nlist[i].cbegin(); pos != hash_nlist[i].cend(); ++pos) { // for each node n in the circuit
-      n = (*pos).get();
+  /*walk through every node in the circuit, in the order of creation */
+  for (i = 0; i < nlist.size(); i++) { // for each node n in the circuit
+    n = nlist[i];
     
-      for (wptr w: n->iwire) { //insert node n into the onode of its iwires
-        w->onode.push_back(n);
-      }
-      
-      for (wptr w: n->owire) { //insert node n into the inode of its owires
-        w->inode.push_back(n);
-      }// for w
-    }// for n
-  }// for i
+    for (wptr w: n->iwire) { //insert node n into the onode of its iwires
+      w->onode.push_back(n);
+    }
+    
+    for (wptr w: n->owire) { //insert node n into the inode of its owires
+      w->inode.push_back(n);
+    }// for w
+  }// for n
 }
 
-int ATPG::FindType(const string& gatetype) {
+int ATPG::FindType(const TOKEN& gatetype) {
   if (gatetype == "and") return(AND);
   if (gatetype == "AND") return(AND);
   if (gatetype == "nand") return(NAND);
@@ -308,45 +375,41 @@ void ATPG::timer(FILE* file, const string& mesg1) {
 
 /* this function is acitve only when the debug variable is turned on */
 void ATPG::display_circuit(void) {
-  int i;
-
   fprintf(stdout,"\n");
-  for (i = 0; i < HASHSIZE; i++) {
-    for (auto pos = hash_nlist[i].cbegin(), end = hash_nlist[i].cend(); pos != end; ++pos) {
-     fprintf(stdout,"%s ",(*pos)->name.c_str());
-     switch((*pos)->type) {
-      case AND :
-         fprintf(stdout,"and ");
-         break;
-      case NAND :
-         fprintf(stdout,"nand ");
-         break;
-      case OR :
-         fprintf(stdout,"or ");
-         break;
-      case NOR :
-         fprintf(stdout,"nor ");
-         break;
-      case BUF :
-         fprintf(stdout,"buf ");
-         break;
-      case NOT :
-         fprintf(stdout,"not ");
-         break;
-      case XOR :
-         fprintf(stdout,"xor ");
-         break;
-      case EQV :
-         fprintf(stdout,"eqv ");
-         break;
-      }
-      for (auto pos1 = (*pos)->iwire.cbegin(), end1 = (*pos)->iwire.cend(); pos1 != end1; ++pos1) {
-        fprintf(stdout,"%s ",(*pos1)->name.c_str());
-      }
-      fprintf(stdout,"; ");
-      for (auto pos1 = (*pos)->owire.cbegin(), end1 = (*pos)->owire.cend(); pos1 != end1; ++pos1) {
-        fprintf(stdout,"%s\n",(*pos1)->name.c_str());
-      }
+  for (auto pos = nlist.cbegin(), end = nlist.cend(); pos != end; ++pos) {
+   fprintf(stdout,"%s ",(*pos)->name.c_str());
+   switch((*pos)->type) {
+    case AND :
+       fprintf(stdout,"and ");
+       break;
+    case NAND :
+       fprintf(stdout,"nand ");
+       break;
+    case OR :
+       fprintf(stdout,"or ");
+       break;
+    case NOR :
+       fprintf(stdout,"nor ");
+       break;
+    case BUF :
+       fprintf(stdout,"buf ");
+       break;
+    case NOT :
+       fprintf(stdout,"not ");
+       break;
+    case XOR :
+       fprintf(stdout,"xor ");
+       break;
+    case EQV :
+       fprintf(stdout,"eqv ");
+       break;
+    }
+    for (auto pos1 = (*pos)->iwire.cbegin(), end1 = (*pos)->iwire.cend(); pos1 != end1; ++pos1) {
+      fprintf(stdout,"%s ",(*pos1)->name.c_str());
+    }
+    fprintf(stdout,"; ");
+    for (auto pos1 = (*pos)->owire.cbegin(), end1 = (*pos)->owire.cend(); pos1 != end1; ++pos1) {
+      fprintf(stdout,"%s\n",(*pos1)->name.c_str());
     }
   }
   fprintf(stdout,"i ");
@@ -361,18 +424,16 @@ void ATPG::display_circuit(void) {
   fprintf(stdout,"\n");
 
   fprintf(stdout,"\n");
-  for (i = 0; i < HASHSIZE; i++) {
-    for (auto pos = hash_wlist[i].cbegin(), end = hash_wlist[i].cend(); pos != end; ++pos) {
-      fprintf(stdout,"%s ",(*pos)->name.c_str());
-      for (auto pos1 = (*pos)->inode.cbegin(), end1 = (*pos)->inode.cend(); pos1 != end1; ++pos1) {
-        fprintf(stdout,"%s ",(*pos1)->name.c_str());
-      }
-      fprintf(stdout,";");
-      for (auto pos1 = (*pos)->onode.cbegin(), end1 = (*pos)->onode.cend(); pos1 != end1; ++pos1) {
-        fprintf(stdout,"%s ",(*pos1)->name.c_str());
-      }
-      fprintf(stdout,"\n");
+  for (auto pos = wlist.cbegin(), end = wlist.cend(); pos != end; ++pos) {
+    fprintf(stdout,"%s ",(*pos)->name.c_str());
+    for (auto pos1 = (*pos)->inode.cbegin(), end1 = (*pos)->inode.cend(); pos1 != end1; ++pos1) {
+      fprintf(stdout,"%s ",(*pos1)->name.c_str());
+    }
+    fprintf(stdout,";");
+    for (auto pos1 = (*pos)->onode.cbegin(), end1 = (*pos)->onode.cend(); pos1 != end1; ++pos1) {
+      fprintf(stdout,"%s ",(*pos1)->name.c_str());
     }
+    fprintf(stdout,"\n");
   }
   return;
 } /* end of display_circuit */
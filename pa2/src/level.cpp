@@ -8,81 +8,92 @@
 #include <utility>
 #include "atpg.h"
 
+/* The circuit is levelled in two passes, both linear in the circuit size.
+ *
+ * 1. Kahn's algorithm gives the level of every wire.  A gate output is
+ *    levelled as soon as its last gate input is levelled; until then its
+ *    wlist_index counts the gate inputs not yet levelled.
+ *
+ * 2. The order of the wires within a level is the order in which the
+ *    original event list scheduled them: the event list is walked level by
+ *    level, a node is scheduled at the level of its output wire, otherwise
+ *    it is pushed again to wait for the next level.  The nodes that were
+ *    ever put into the event list are flagged SCHEDULED, so that no list
+ *    search is needed to keep each node in the list only once. */
 void ATPG::level_circuit(void) {
-  nptr ncurrent,nprelast;
-  bool schedule;
-  int level = 0;
-  list<nptr> event_list;         // event list linked queue
-  forward_list<wptr> wire_stack; // stack of wires to be labeled for a given level
-  
-  /* levels are propagated from PI to PO (like events) */
-  /* build up the initial node event list */
+  int level, i;
+  vector<wptr> wire_queue;       // levelled wires whose fanout is not yet visited
+  vector<nptr> event_list;       // nodes to be evaluated for this level
+  vector<nptr> next_event_list;  // nodes to be evaluated for the next level
+
+  /* 1. levels are propagated from PI to PO (like events) */
+  for (auto pos = nlist.cbegin(), end = nlist.cend(); pos != end; ++pos) {
+    for (wptr wptr_ele: (*pos)->owire) {
+      wptr_ele->wlist_index = (*pos)->iwire.size(); // number of gate inputs not yet levelled
+      wptr_ele->level = 0;
+    }
+  }
+  for (wptr wptr_ele: cktin) {
+    wptr_ele->level = 0;  // PI level =0
+    wire_queue.push_back(wptr_ele);
+  }
+  for (i = 0; i < wire_queue.size(); i++) {
+    for (nptr nptr_ele: wire_queue[i]->onode) {
+      for (wptr wptr_ele: nptr_ele->owire) {
+        wptr_ele->level = max(wptr_ele->level, wire_queue[i]->level + 1);
+        if (--wptr_ele->wlist_index == 0) { // the last gate input is levelled
+          wire_queue.push_back(wptr_ele);
+        }
+      }
+    }
+  }
+
+  /* 2. build up the initial node event list, in the order of
+   * the original linked queue: the node seen first is at the end */
   for (wptr wptr_ele: cktin) {
     sort_wlist.push_back(wptr_ele);
     wptr_ele->wlist_index = (int)sort_wlist.size()-1;
-    wptr_ele->flag |= MARKED; // MARKED means the PI is already leveled
-    wptr_ele->level = level;  // PI level =0
     for (nptr nptr_ele: wptr_ele->onode) {
-      if (find(event_list.begin(), event_list.end(), nptr_ele) == event_list.end()) // if this node not yet in event list
-        event_list.push_front(nptr_ele); //add to the front of event list
+      if (!(nptr_ele->flag & SCHEDULED)) { // if this node not yet in event list
+        nptr_ele->flag |= SCHEDULED;
+        event_list.push_back(nptr_ele);
+      }
     }
   }
-  nprelast = *event_list.rbegin();
-  /*  the event list linked queue is like this
-	n             nnnnnnnnnnnnnnnnnnnnnnnnnnnnnNNNNNNNNNNNNNNNNNNNNNNNNNNNNN
-	^             ^                           ^                            ^
-	ncurrent      *event_list.begin()         nprelast                     *event_list.rbegin()
+  reverse(event_list.begin(), event_list.end());
 
-	ncurrent points to the node under evaluation now
-	event_list.begin() points to the front of the queue  (exit)
-	event_list.end() points to the end of queue (entrance)
-	n = nodes to be evaluated for this level
-  N = nodes to be evaluated for the next level
-  */
+  level = 0;
   while (!event_list.empty()) { // go through all nodes in the event list (for this level)
-    ncurrent = event_list.front(); // get a node from the front of event list
-    event_list.pop_front();
-    schedule = true;
-    for (wptr wptr_ele: ncurrent->iwire) { // check every gate input
-      if (!(wptr_ele->flag & MARKED)) { // if any one gate input is not marked yet
-        schedule = false;  // do not schedule this event
-      }
-    }
-    if (schedule) {
-      for (wptr wptr_ele: ncurrent->owire) {
-        sort_wlist.push_back(wptr_ele);  //insert node output wire to sort_wlist
-        wptr_ele->wlist_index = (int)sort_wlist.size()-1;
-        wire_stack.push_front(wptr_ele); // push node output to stack to be leveled
-        for (nptr nptr_ele: wptr_ele->onode) { // propagate the event to fanout node
-          if (find(event_list.begin(), event_list.end(), nptr_ele) == event_list.end()) // if not in the event list
-            event_list.push_back(nptr_ele); // append to end of event list
+    for (nptr ncurrent: event_list) {
+      /* a node is scheduled when all of its gate inputs are leveled,
+       * i.e. at the level just before its output wire */
+      if (ncurrent->owire.empty() || (ncurrent->owire.front()->level == level + 1)) {
+        for (wptr wptr_ele: ncurrent->owire) {
+          sort_wlist.push_back(wptr_ele);  //insert node output wire to sort_wlist
+          wptr_ele->wlist_index = (int)sort_wlist.size()-1;
+          for (nptr nptr_ele: wptr_ele->onode) { // propagate the event to fanout node
+            if (!(nptr_ele->flag & SCHEDULED)) { // if not in the event list
+              nptr_ele->flag |= SCHEDULED;
+              next_event_list.push_back(nptr_ele); // append to end of event list
+            }
+          }
         }
+      } // if schedule
+      else { // if this node is not scheduled, it waits for the next level
+        next_event_list.push_back(ncurrent);
       }
-    } // if schedule
-    else { // if this node is not scheduled
-      if (find(event_list.begin(), event_list.end(), ncurrent) == event_list.end()) // if not in the event list
-        event_list.push_back(ncurrent); // re-push this node back to the event list linked queue
     }
-    
-    /* when finish all nodes in the event list for a given level,
-	     mark level to all wires in the stack*/ 
-    if (ncurrent == nprelast) {
-      level++;
-      while (!wire_stack.empty()) { // pop every wire in the stack and mark them
-        wire_stack.front()->flag |= MARKED;
-        wire_stack.front()->level = level;
-        wire_stack.pop_front();
-      }
-      nprelast = *event_list.rbegin();
-    } // if ncurent
-  } // while (nfirst) , starts the next level
+    event_list.swap(next_event_list);
+    next_event_list.clear();
+    level++;
+  } // while event_list, starts the next level
 
-  /* after the whole circuit is done, unmark each wire */
+  /* after the whole circuit is done, unmark each node */
   for (wptr wptr_ele: sort_wlist) {
-    wptr_ele->flag &= ~MARKED;
-    //cout << wptr_ele->name << " " << wptr_ele->level << endl;
+    for (nptr nptr_ele: wptr_ele->onode) {
+      nptr_ele->flag &= ~SCHEDULED;
+    }
   }
-  //cout << "size of sort_wlist: " << sort_wlist.size() << endl;
 }/* end of level */
 
 /* for all gates in the circuits,
@@ -3,29 +3,43 @@
 #define D  3
 #define B  4  // D_bar
 
-/* five-valued truth table */
-int ANDTABLE[MULTIVALUE][MULTIVALUE] =  { 0,  0,  0,  0,  0,
-								     0,  1,  U,  D,  B,
-                                          0,  U,  U,  U,  U,
-								     0,  D,  U,  D,  0,
-                                          0,  B,  U,  0,  B };
+/* five-valued logic, encoded in four bits so that a gate is evaluated for
+ * the good and the faulty machine at once with a few bitwise operations
+ *   bit 0: good value is 1      bit 1: good value is 0
+ *   bit 2: faulty value is 1    bit 3: faulty value is 0
+ * 0 = 1010, 1 = 0101, D = 1001 (1/0), B = 0110 (0/1), U = 0000.
+ * AND is an AND of the "is 1" bits and an OR of the "is 0" bits, and INV
+ * swaps them.  As in the five-valued truth tables, a result that is
+ * unknown in either machine is U, after every two-input step. */
+#define L5_ONE  0x5U   // the "is 1" bits of both machines
+#define L5_ZERO 0xaU   // the "is 0" bits of both machines
 
-int ORTABLE[MULTIVALUE][MULTIVALUE]  =  { 0,  1,  U,  D,  B,
-								     1,  1,  1,  1,  1,
-								     U,  1,  U,  U,  U,
-								     D,  1,  U,  D,  1,
-								     B,  1,  U,  1,  B };
+/* value (0, 1, U, D or B) to code and code to value, looked up in a
+ * constant rather than in memory: four bits per entry */
+#define L5_ENCODE(v) ((0x6905aU >> ((v) << 2)) & 0xfU)
+#define L5_DECODE(c) ((int) ((0x2222203224122222ULL >> ((c) << 2)) & 0xfU))
 
-int XORTABLE[MULTIVALUE][MULTIVALUE] =  { 0,  1,  U,  D,  B,
-								     1,  0,  U,  B,  D,
-								     U,  U,  U,  U,  U,
-								     D,  B,  U,  0,  1,
-								     B,  D,  U,  1,  0 };
- 
-int EQVTABLE[MULTIVALUE][MULTIVALUE] =  { 1,  0,  U,  B,  D,
-								     0,  1,  U,  D,  B,
-								     U,  U,  U,  U,  U,
-								     B,  D,  U,  1,  0,
-								     D,  B,  U,  0,  1 };
+/* c if both machines are known, U otherwise */
+static inline unsigned int l5_known(const unsigned int c) {
+  unsigned int good = (c | (c >> 1)) & 1U;
+  unsigned int faulty = ((c >> 2) | (c >> 3)) & 1U;
+  return(c & (0U - (good & faulty)));
+}
 
-int INV[MULTIVALUE] = { 1,  0,  U,  B,  D };
+static inline unsigned int l5_inv(const unsigned int c) {
+  return(((c & L5_ONE) << 1) | ((c & L5_ZERO) >> 1));
+}
+
+static inline unsigned int l5_and(const unsigned int a, const unsigned int b) {
+  return(l5_known((a & b & L5_ONE) | ((a | b) & L5_ZERO)));
+}
+
+static inline unsigned int l5_or(const unsigned int a, const unsigned int b) {
+  return(l5_known(((a | b) & L5_ONE) | (a & b & L5_ZERO)));
+}
+
+static inline unsigned int l5_xor(const unsigned int a, const unsigned int b) {
+  unsigned int a1 = a & L5_ONE, a0 = (a >> 1) & L5_ONE;
+  unsigned int b1 = b & L5_ONE, b0 = (b >> 1) & L5_ONE;
+  return(l5_known((a1 & b0) | (a0 & b1) | (((a1 & b1) | (a0 & b0)) << 1)));
+}
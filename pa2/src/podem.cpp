@@ -10,32 +10,52 @@
 #include <unordered_set>
 
 #define CONFLICT 2
+#define XPATH_SINK -1   /* xpath_ipdom of a wire dominated by no wire */
+#define XPATH_NO_PO -2  /* xpath_ipdom of a wire that reaches no PO */
 
 /* generates a single pattern for a single fault */
 int ATPG::podem(const fptr fault, int& current_backtracks) {
   int i,ncktwire,ncktin;
   wptr wpi; // points to the PI currently being assigned
   forward_list<wptr> decision_tree; // design_tree (a LIFO stack)
+  forward_list<int> decision_mark;  // size of imply_trail before each decision, see undo_imply
   wptr wfault;
   int attempt_num = 0;  // counts the number of pattern generated so far for the given fault
+  int mark;
 
-  /* initialize all circuit wires to unknown */
+  /* initialize all circuit wires to unknown.
+   * the fault simulation between two calls overwrites the values, so this
+   * is the only full pass; from now on only the changed wires are visited */
   ncktwire = sort_wlist.size();
   ncktin = cktin.size();
   for (i = 0; i < ncktwire; i++) {
     sort_wlist[i]->value = U;
   }
+  imply_trail.clear();
+  imply_bucket.resize(sort_wlist.back()->level + 1);
+  d_frontier.clear();
+  if (xpath_ipdom.size() != ncktwire) compute_xpath_dominators();
+  if (backward_stamp.size() != 2 * ncktwire) backward_stamp.assign(2 * ncktwire, 0);
+  for (int c: xpath_cached) xpath_witness[c].clear();
+  xpath_cached.clear();
   no_of_backtracks = 0;
   find_test = false;
   no_test = false;
   
-  mark_propagate_tree(fault->node);
+  /* the D-frontier is restricted to the fanout cone of the faulty gate output */
+  propagate_site = (fault->node->type == OUTPUT) ? -1 : fault->node->owire.front()->wlist_index;
+
+  /* dynamic compaction: the PIs of the vector under construction keep their
+   * values.  they are below every decision, so they are never taken back */
+  for (i = 0; i < test_cube.size(); i++) {
+    if (test_cube[i] != U) imply_assign(cktin[i], test_cube[i]);
+  }
 
   /* Fig 7 starts here */
   /* set the initial goal, assign the first PI.  Fig 7.P1 */
   switch (set_uniquely_implied_value(fault)) {
     case TRUE: // if a  PI is assigned 
-      sim();  // Fig 7.3
+      imply();  // Fig 7.3
       wfault = fault_evaluate(fault);
       if (wfault != nullptr) forward_imply(wfault);// propagate fault effect
       if (check_test()) find_test = true; // if fault effect reaches PO, done. Fig 7.10
@@ -56,10 +76,11 @@ int ATPG::podem(const fptr fault, int& current_backtracks) {
     !(find_test && (attempt_num == total_attempt_num))) {
     
     /* check if test possible.   Fig. 7.1 */
+    mark = imply_trail.size();
     if (wpi = test_possible(fault)) {
-      wpi->flag |= CHANGED;
       /* insert a new PI into decision_tree */
       decision_tree.push_front(wpi);
+      decision_mark.push_front(mark);
     }
     else { // no test possible using this assignment, backtrack. 
 
@@ -67,15 +88,17 @@ int ATPG::podem(const fptr fault, int& current_backtracks) {
         /* if both 01 already tried, backtrack. Fig.7.7 */
         if (decision_tree.front()->flag & ALL_ASSIGNED) {
           decision_tree.front()->flag &= ~ALL_ASSIGNED;  // clear the ALL_ASSIGNED flag
-          decision_tree.front()->value = U; // do not assign 0 or 1
-          decision_tree.front()->flag |= CHANGED; // this PI has been changed
+          /* take back this PI (back to U) and everything implied since */
+          undo_imply(decision_mark.front());
           /* remove this PI in decision tree.  see dashed nodes in Fig 6 */
           decision_tree.pop_front();
+          decision_mark.pop_front();
         }  
         /* else, flip last decision, flag ALL_ASSIGNED. Fig. 7.8 */
         else {
-          decision_tree.front()->value = decision_tree.front()->value ^ 1; // flip last decision
-          decision_tree.front()->flag |= CHANGED; // this PI has been changed
+          i = decision_tree.front()->value ^ 1;
+          undo_imply(decision_mark.front());
+          imply_assign(decision_tree.front(), i); // flip last decision
           decision_tree.front()->flag |= ALL_ASSIGNED;
           no_of_backtracks++;
           wpi = decision_tree.front(); 
@@ -87,7 +110,7 @@ int ATPG::podem(const fptr fault, int& current_backtracks) {
 /* this again loop is to generate multiple patterns for a single fault 
  * this part is NOT in the original PODEM paper  */
 again:  if (wpi) {
-      sim();
+      imply();
       if (wfault = fault_evaluate(fault)) forward_imply(wfault);
       if (check_test()) {
         find_test = true;
@@ -108,14 +131,15 @@ again:  if (wpi) {
             /* backtrack */
             if (decision_tree.front()->flag & ALL_ASSIGNED) {
               decision_tree.front()->flag &= ~ALL_ASSIGNED;
-              decision_tree.front()->value = U;
-              decision_tree.front()->flag |= CHANGED;
+              undo_imply(decision_mark.front());
               decision_tree.pop_front();
+              decision_mark.pop_front();
             }
             /* flip last decision */
             else {
-              decision_tree.front()->value = decision_tree.front()->value ^ 1;
-              decision_tree.front()->flag |= CHANGED;
+              i = decision_tree.front()->value ^ 1;
+              undo_imply(decision_mark.front());
+              imply_assign(decision_tree.front(), i);
               decision_tree.front()->flag |= ALL_ASSIGNED;
               no_of_backtracks++;
               wpi = decision_tree.front();
@@ -133,13 +157,15 @@ again:  if (wpi) {
     wptr_ele->flag &= ~ALL_ASSIGNED;
   }
   decision_tree.clear();
+  decision_mark.clear();
+  clear_imply_queue(); // a conflicting initial objective leaves its events behind
   
   current_backtracks = no_of_backtracks;
-  unmark_propagate_tree(fault->node);
   
   if (find_test) {
-    /* normally, we want one pattern per fault */
-    if (total_attempt_num == 1) {
+    /* normally, we want one pattern per fault.  with dynamic compaction the
+     * unassigned PIs are left to compact_test_cube */
+    if ((total_attempt_num == 1) && (compaction_limit == 0)) {
 	  
       for (i = 0; i < ncktin; i++) {
         switch (cktin[i]->value) {
@@ -150,9 +176,8 @@ again:  if (wpi) {
         case U: cktin[i]->value = rand()&01; break; // random fill U
         }
       }
-      display_io();
     }
-    else fprintf(stdout, "\n");  // do not random fill when multiple patterns per fault
+    else if (total_attempt_num > 1) fprintf(stdout, "\n");  // do not random fill when multiple patterns per fault
     return(TRUE);
   }
   else if (no_test) {
@@ -177,8 +202,8 @@ ATPG::wptr ATPG::fault_evaluate(const fptr fault) {
   if (fault->io == GO) { // if fault is on GUT gate output
     w = fault->node->owire.front(); // w is GUT output wire
     if (w->value == U) return(nullptr);
-    if (fault->fault_type == STUCK0 && w->value == 1) w->value = D; // D means 1/0
-    if (fault->fault_type == STUCK1 && w->value == 0) w->value = B; // B_bar 0/1
+    if (fault->fault_type == STUCK0 && w->value == 1) trail_value(w, D); // D means 1/0
+    if (fault->fault_type == STUCK1 && w->value == 0) trail_value(w, B); // B_bar 0/1
     return(w);
   }
   else { // if fault is GUT gate input
@@ -186,10 +211,15 @@ ATPG::wptr ATPG::fault_evaluate(const fptr fault) {
     if (w->value == U) return(nullptr);
     else {
       temp1 = w->value;
+      /* a fault on a PO: the fault effect stays on the wire, see check_test */
+      if (fault->node->type == OUTPUT) {
+        if (fault->fault_type == STUCK0 && w->value == 1) trail_value(w, D);
+        if (fault->fault_type == STUCK1 && w->value == 0) trail_value(w, B);
+        return(nullptr);
+      }
       if (fault->fault_type == STUCK0 && w->value == 1) w->value = D;
       if (fault->fault_type == STUCK1 && w->value == 0) w->value = B;
-      if (fault->node->type == OUTPUT) return(nullptr);
-      evaluate(fault->node);  // five-valued, evaluate one gate only, sim.c
+      imply_evaluate(fault->node->owire.front()->wlist_index);  // five-valued, evaluate one gate only, sim.c
       w->value = temp1;
 	  /* if GUT gate output changed */
       if (fault->node->owire.front()->flag & CHANGED) {
@@ -202,20 +232,133 @@ ATPG::wptr ATPG::fault_evaluate(const fptr fault) {
 }/* end of fault_evaluate */
 
 
-/* iteratively foward implication
- * in a depth first search manner*/ 
+/* foward implication of the fault effect on w: the fanout of w is
+ * scheduled and evaluated level by level, see imply */
 void ATPG::forward_imply(const wptr w) {
-  int i,nout;
-
-  for (i = 0, nout = w->onode.size(); i < nout; i++) {
-    if (w->onode[i]->type != OUTPUT) {
-      evaluate(w->onode[i]);
-      if (w->onode[i]->owire.front()->flag & CHANGED)
-	    forward_imply(w->onode[i]->owire.front()); // go one level further
-      w->onode[i]->owire.front()->flag &= ~CHANGED;
+  schedule_fanout(w->wlist_index);
+  imply();
+}/* end of forward_imply */
+
+
+/* The implications of PODEM are incremental.  Every value written by podem
+ * goes through the functions below and is pushed on imply_trail together with
+ * the value it replaced, so a backtrack pops the trail down to the size it had
+ * before the decision (undo_imply) instead of simulating the circuit again.
+ * A newly assigned PI schedules its fanout in imply_bucket[level], and imply
+ * evaluates the scheduled wires level by level, like sim does, but without
+ * walking the wires that are not reached by the change. */
+
+/* set w to v and remember the old value */
+void ATPG::trail_value(const wptr w, const int& v) {
+  imply_trail.push_back(make_pair(w, w->value));
+  w->value = v;
+  if ((v == D) || (v == B)) push_d_frontier(w->wlist_index);
+}/* end of trail_value */
+
+/* assign a PI and schedule its fanout for imply */
+void ATPG::imply_assign(const wptr w, const int& v) {
+  if (w->value == v) return;
+  trail_value(w, v);
+  schedule_fanout(w->wlist_index);
+}/* end of imply_assign */
+
+/* schedule the fanout of wire w_index for imply */
+void ATPG::schedule_fanout(const int& w_index) {
+  int i, j;
+
+  for (i = fanout_start[w_index]; i < fanout_start[w_index + 1]; i++) {
+    j = fanout_index[i];
+    if (sort_wlist[j]->flag & SCHEDULED) continue;
+    sort_wlist[j]->flag |= SCHEDULED;
+    imply_bucket[sort_wlist[j]->level].push_back(j);
+    imply_pending++;
+  }
+}/* end of schedule_fanout */
+
+/* evaluate one gate, the CHANGED flag is left to the caller */
+void ATPG::imply_evaluate(const int& w_index) {
+  int old_value = sort_wlist[w_index]->value;
+
+  evaluate(w_index);
+  if (sort_wlist[w_index]->flag & CHANGED) {
+    imply_trail.push_back(make_pair(sort_wlist[w_index], old_value));
+    if ((sort_wlist[w_index]->value == D) || (sort_wlist[w_index]->value == B)) push_d_frontier(w_index);
+  }
+}/* end of imply_evaluate */
+
+/* evaluate the scheduled wires in increasing level order */
+void ATPG::imply(void) {
+  int i, k, level;
+  wptr w;
+
+  for (level = 0; imply_pending > 0; level++) {
+    for (k = 0; k < imply_bucket[level].size(); k++) {
+      i = imply_bucket[level][k];
+      w = sort_wlist[i];
+      w->flag &= ~SCHEDULED;
+      imply_pending--;
+      imply_evaluate(i);
+      if (!(w->flag & CHANGED)) continue;
+      w->flag &= ~CHANGED;
+      schedule_fanout(i);
     }
+    imply_bucket[level].clear();
   }
-}/* end of forward_imply */
+}/* end of imply */
+
+/* restore the values saved since imply_trail had mark entries */
+void ATPG::undo_imply(const int& mark) {
+  wptr w;
+
+  clear_imply_queue();
+  while (imply_trail.size() > mark) {
+    w = imply_trail.back().first;
+    if ((w->value == D) || (w->value == B)) {
+      d_frontier.resize(d_frontier.size() - (fanout_start[w->wlist_index + 1] - fanout_start[w->wlist_index]));
+    }
+    w->value = imply_trail.back().second;
+    imply_trail.pop_back();
+  }
+}/* end of undo_imply */
+
+/* drop the wires scheduled but not evaluated yet */
+void ATPG::clear_imply_queue(void) {
+  if (imply_pending == 0) return;
+  for (vector<int>& bucket: imply_bucket) {
+    for (int i: bucket) sort_wlist[i]->flag &= ~SCHEDULED;
+    bucket.clear();
+  }
+  imply_pending = 0;
+}/* end of clear_imply_queue */
+
+/* The D-frontier (gates on the path to PO with D or B on an input and U on
+ * the output) can only contain a gate fed by a wire holding D or B.  When a
+ * wire takes D or B, its fanout is pushed on d_frontier, and undo_imply pops
+ * it again with the trail entry.  A gate stays in d_frontier after its
+ * output is assigned or its D input goes away without undo (e.g. the fault
+ * site re-evaluated by imply), so find_propagate_gate checks every entry with
+ * in_d_frontier.  Either way, only the fault effect is visited instead of
+ * the whole circuit. */
+void ATPG::push_d_frontier(const int& w_index) {
+  int i;
+
+  for (i = fanout_start[w_index]; i < fanout_start[w_index + 1]; i++) {
+    d_frontier.push_back(fanout_index[i]);
+  }
+}/* end of push_d_frontier */
+
+/* true if wire w_index is the output of a D-frontier gate */
+bool ATPG::in_d_frontier(const int& w_index) {
+  int i, v;
+
+  if ((sort_wlist[w_index]->value != U) || (propagate_site < 0) ||
+      !in_fanout_cone(propagate_site, w_index)) return(false);
+  for (i = fanin_start[w_index]; i < fanin_start[w_index + 1]; i++) {
+    v = sort_wlist[fanin_index[i]]->value;
+    if ((v == D) || (v == B)) return(true);
+  }
+  return(false);
+}/* end of in_d_frontier */
 
 
 /* Fig 8 
@@ -334,161 +477,231 @@ ATPG::wptr ATPG::test_possible(const fptr fault) {
 
 /* backtrace to PI, assign a PI to achieve the objective.  Fig 9
  * returns the wire pointer to PI if succeed.
- * returns NULL if no such PI found. */
+ * returns NULL if no such PI found. 
+ * the backtrace follows a single path, so it is a loop */
 ATPG::wptr ATPG::find_pi_assignment(const wptr object_wire, const int& object_level) {
-  wptr new_object_wire;
+  wptr w = object_wire;
+  int level = object_level;
   int new_object_level;
-  
-  /* if PI, assign the same value as objective Fig 9.1, 9.2 */
-  if (object_wire->flag & INPUT) {
-    object_wire->value = object_level;
-    return(object_wire);
-  }
+  nptr n;
 
   /* if not PI, backtrace to PI  Fig 9.3, 9.4, 9.5*/
-  else {
-    switch(object_wire->inode.front()->type) {
+  while (!(w->flag & INPUT)) {
+    n = w->inode.front();
+    switch (n->type) {
+      case  BUF:
+      case  AND:
+      case   OR: new_object_level = level; break;
+      /* flip objective value  Fig 9.6 */
+      case  NOT:
+      case  NOR:
+      case NAND: new_object_level = level ^ 1; break;
+      default: return(nullptr);
+    }
+
+    /* new_object_level is the value wanted on the gate input */
+    switch (n->type) {
       case   OR:
       case NAND:
-        if (object_level) new_object_wire = find_easiest_control(object_wire->inode.front());  // decision gate
-        else new_object_wire = find_hardest_control(object_wire->inode.front()); // imply gate
+        if (level) w = find_easiest_control(n, new_object_level);  // decision gate
+        else w = find_hardest_control(n, new_object_level); // imply gate
         break;
       case  NOR:
       case  AND:
-		// TODO find the input wire  
-    // Hint similar to OR and NAND but different polarity
-    //--------------------------------- hole -------------------------------------------
-        if (object_level) new_object_wire = find_hardest_control(object_wire->inode.front());
-        else new_object_wire = find_easiest_control(object_wire->inode.front());
+        if (level) w = find_hardest_control(n, new_object_level);
+        else w = find_easiest_control(n, new_object_level);
         break;
-    //----------------------------------------------------------------------------------
-		//  TODO 
       case  NOT:
       case  BUF:
-        new_object_wire = object_wire->inode.front()->iwire.front();
+        w = n->iwire.front();
         break;
     }
-
-    switch (object_wire->inode.front()->type) {
-      case  BUF:
-      case  AND:
-      case   OR: new_object_level = object_level; break;
-      /* flip objective value  Fig 9.6 */
-      case  NOT:
-      case  NOR:
-      case NAND: new_object_level = object_level ^ 1; break;
-    }
-    if (new_object_wire) return(find_pi_assignment(new_object_wire,new_object_level));
-    else return(nullptr);
+    if (w == nullptr) return(nullptr);
+    level = new_object_level;
   }
+
+  /* if PI, assign the same value as objective Fig 9.1, 9.2 */
+  imply_assign(w, level);
+  return(w);
 }/* end of find_pi_assignment */
 
 
-/* Fig 9.4 */
-ATPG::wptr ATPG::find_hardest_control(const nptr n) {
-  int i;
-  /* because gate inputs are arranged in a increasing level order,
-   * larger input index means harder to control */
+/* Fig 9.4
+ * returns the unknown input of n that is the hardest to set to value,
+ * i.e. the one with the largest SCOAP controllability (see scoap.cpp).
+ * on a tie, the input of the larger level */
+ATPG::wptr ATPG::find_hardest_control(const nptr n, const int& value) {
+  int i, cost;
+  wptr w = nullptr;
+  int max_cost = -1;
+
   for (i = n->iwire.size() - 1; i >= 0; i--) {
-    if (n->iwire[i]->value == U) return(n->iwire[i]);
+    if (n->iwire[i]->value != U) continue;
+    cost = value ? cc1[n->iwire[i]->wlist_index] : cc0[n->iwire[i]->wlist_index];
+    if (cost > max_cost) {
+      max_cost = cost;
+      w = n->iwire[i];
+    }
   }
-  return(nullptr);
+  return(w);
 }/* end of find_hardest_control */
 
 
-/* Fig 9.5 */
-ATPG::wptr ATPG::find_easiest_control(const nptr n) {
-  int i, nin;
-  // TODO  find the input with min level
-  // Hint: similar to hardiest_control but increasing level order
-  //--------------------------------- hole -------------------------------------------
+/* Fig 9.5
+ * returns the unknown input of n that is the easiest to set to value,
+ * i.e. the one with the smallest SCOAP controllability.
+ * on a tie, the input of the smaller level */
+ATPG::wptr ATPG::find_easiest_control(const nptr n, const int& value) {
+  int i, nin, cost;
+  wptr w = nullptr;
+  int min_cost = 0;
+
   for (i = 0, nin = n->iwire.size(); i < nin; ++i) {
-    if (n->iwire[i]->value == U) return n->iwire[i];
+    if (n->iwire[i]->value != U) continue;
+    cost = value ? cc1[n->iwire[i]->wlist_index] : cc0[n->iwire[i]->wlist_index];
+    if ((w == nullptr) || (cost < min_cost)) {
+      min_cost = cost;
+      w = n->iwire[i];
+    }
   }
-  //----------------------------------------------------------------------------------
-  //  TODO 
-  return(nullptr);
+  return(w);
 }/* end of find_easiest_control */
 
 
 /* Find the eastiest propagation gate.   Fig 8.5, Fig 8.6 
- * returns the next gate with D or B on inputs, U on output, nearest to PO
+ * returns the next gate with D or B on inputs, U on output and an X path,
+ * the one with the smallest SCOAP observability (see scoap.cpp).
+ * on a tie, the one nearest to PO.
+ * only the gates above the level of the fault are considered.
  * returns NULL if no such gate found. */
 ATPG::nptr ATPG::find_propagate_gate(const int& level) {
-  int i,j,nin;
-  wptr w;
+  int f;
+  vector<int> frontier; // the D-frontier above level, see push_d_frontier
+  /* heap order: the gate with the smallest co (then the largest index) on top */
+  auto later = [&](const int a, const int b){ return (co[a] != co[b]) ? (co[a] > co[b]) : (a < b); };
 
-  /* check every wire in decreasing level order
-   * so that wires nearer to PO is checked earlier. */
-  for (i = sort_wlist.size() - 1; i >= 0; i--) {
-    /* if reach the same level as the fault, then no propagation path exists */
-    if (sort_wlist[i]->level == level) return(nullptr);
-    /* gate outptu is U */
-    /* a marked gate means it is on the path to PO */
-    if ((sort_wlist[i]->value == U) &&
-        (sort_wlist[i]->inode.front()->flag & MARKED)) { 
-      /*  cehck all gate intputs */  
-      for (j = 0, nin = sort_wlist[i]->inode.front()->iwire.size(); j < nin; j++) {
-        w = sort_wlist[i]->inode.front()->iwire[j];
-        /* if there is ont gate intput is D or B */
-        if ((w->value == D) || (w->value == B)) {
-          if (trace_unknown_path(sort_wlist[i])) // check X path  Fig 8.6
-            return(sort_wlist[i]->inode.front()); // succeed.  returns this gate
-          break;
-        }
-      }
-    }
+  for (int f: d_frontier) {
+    if ((sort_wlist[f]->level > level) && in_d_frontier(f)) frontier.push_back(f);
+  }
+  /* a gate with several D inputs is pushed once per input */
+  sort(frontier.begin(), frontier.end());
+  frontier.erase(unique(frontier.begin(), frontier.end()), frontier.end());
+  /* usually the first gate has an X path, so the gates are taken from a
+   * heap instead of sorting the whole frontier */
+  make_heap(frontier.begin(), frontier.end(), later);
+  while (!frontier.empty()) {
+    f = frontier.front();
+    if (trace_unknown_path(sort_wlist[f])) // check X path  Fig 8.6
+      return(sort_wlist[f]->inode.front()); // succeed.  returns this gate
+    pop_heap(frontier.begin(), frontier.end(), later);
+    frontier.pop_back();
   }
+  return(nullptr);
 }/* end of find_propagate_gate */
 
 
-/* DFS search for X-path , Fig 8.6
+/* search for an X-path, Fig 8.6: a path of U wires from w to a PO.
  * returns TRUE if X pth exists
- * returns NULL if no X path exists*/
+ * returns FALSE if no X path exists
+ *
+ * Three shortcuts come before the DFS:
+ * 1. every path from w to a PO goes through the post-dominators of w (see
+ *    compute_xpath_dominators); one of them being assigned kills the X-path.
+ * 2. the last X-path found from w (xpath_witness) is still good if all its
+ *    wires are still U, which is the common case between two decisions.
+ * 3. the DFS never enters a wire that reaches no PO.
+ * A visit is recorded by stamping xpath_stamp, so nothing is cleaned up. */
 bool ATPG::trace_unknown_path(const wptr w) {
-  int i,nout;
-  wptr wtemp;
+  int i, j, k, start;
+  bool found = false;
 
-	//TODO search X-path
-	//HINT if w is PO, return TRUE, if not, check all its fanout 
-	//------------------------------------- hole ---------------------------------------
-  // 1. If w is PO, return TRUE
+  /* 1. If w is PO, return TRUE */
   if (w->flag & OUTPUT) return true;
-  // 2. If not, check all its fanout (DFS)
-  #define DFS_MARKED 2048
-  forward_list<wptr> wire_stack;
-  forward_list<wptr> marked_wire_flist;
-  auto __unmark_and_return = [&](const bool ret) -> bool {
-    while(!marked_wire_flist.empty()) {
-      marked_wire_flist.front()->flag &= ~DFS_MARKED;
-      marked_wire_flist.pop_front();
+  start = w->wlist_index;
+  for (i = xpath_ipdom[start]; i >= 0; i = xpath_ipdom[i]) {
+    if (sort_wlist[i]->value != U) return false;
+  }
+  if (i == XPATH_NO_PO) return false;
+
+  /* 2. the path found last time */
+  if (!xpath_witness[start].empty()) {
+    for (j = 0; j < xpath_witness[start].size(); j++) {
+      if (sort_wlist[xpath_witness[start][j]]->value != U) break;
     }
-    return ret;
-  };
-  auto __push2stack_and_mark = [&](wptr w) -> void {
-    wire_stack.push_front(w);         // push to stack
-    w->flag |= DFS_MARKED;            // mark discovered wires
-    marked_wire_flist.push_front(w);  // add to marked list
-  };
-  __push2stack_and_mark(w);
-  while (!wire_stack.empty()) {
-    wtemp = wire_stack.front(); // stack pop
-    wire_stack.pop_front();     // stack pop
-    for (i = 0, nout = wtemp->onode.size(); i < nout; ++i) {
-      for (wptr wout : wtemp->onode[i]->owire) {
-        if (!(wout->flag & DFS_MARKED) && (wout->value == U)) {
-          if (wout->flag & OUTPUT)
-            return __unmark_and_return(true);
-          __push2stack_and_mark(wout);
-        }
+    if (j == xpath_witness[start].size()) return true;
+  }
+
+  /* 3. DFS through the U wires, xpath_parent remembers the path */
+  xpath_generation++;
+  xpath_stack.clear();
+  xpath_stack.push_back(start);
+  xpath_stamp[start] = xpath_generation;
+  while (!xpath_stack.empty() && !found) {
+    i = xpath_stack.back();
+    xpath_stack.pop_back();
+    for (k = fanout_start[i]; k < fanout_start[i + 1]; k++) {
+      j = fanout_index[k];
+      if ((xpath_stamp[j] == xpath_generation) || (sort_wlist[j]->value != U) ||
+          (xpath_ipdom[j] == XPATH_NO_PO)) continue;
+      xpath_stamp[j] = xpath_generation;
+      xpath_parent[j] = i;
+      if (sort_wlist[j]->flag & OUTPUT) {
+        found = true;
+        break;
       }
+      xpath_stack.push_back(j);
     }
   }
-	//----------------------------------------------------------------------------------
-  return __unmark_and_return(false); // X-path disappear
-  //TODO 
+  if (!found) return false;
+
+  /* keep the path from start (excluded) to the PO for the next call */
+  if (xpath_witness[start].empty()) xpath_cached.push_back(start);
+  xpath_witness[start].clear();
+  for (; j != start; j = xpath_parent[j]) xpath_witness[start].push_back(j);
+  return true;
 }/* end of trace_unknown_path */
 
+/* the immediate post-dominator of every wire in the graph of the gates, a
+ * virtual sink being fed by all POs: every path from wire i to a PO goes
+ * through xpath_ipdom[i].  XPATH_SINK if there is none, XPATH_NO_PO if wire
+ * i reaches no PO at all.  the graph is a DAG, so one pass in reverse level
+ * order is enough.  it depends on the structure only, so it is computed once */
+void ATPG::compute_xpath_dominators(void) {
+  int i, j, k, a, b, nckt;
+
+  nckt = sort_wlist.size();
+  xpath_ipdom.assign(nckt, XPATH_NO_PO);
+  for (i = nckt - 1; i >= 0; i--) {
+    if (sort_wlist[i]->flag & OUTPUT) {
+      xpath_ipdom[i] = XPATH_SINK;
+      continue;
+    }
+    a = XPATH_NO_PO;
+    for (k = fanout_start[i]; k < fanout_start[i + 1]; k++) {
+      j = fanout_index[k];
+      if (xpath_ipdom[j] == XPATH_NO_PO) continue;
+      if (a == XPATH_NO_PO) {
+        a = j;
+        continue;
+      }
+      /* nearest common post-dominator of a and j; wlist_index grows
+       * toward the POs and the sink is above everything */
+      b = j;
+      while ((a != b) && (a != XPATH_SINK) && (b != XPATH_SINK)) {
+        if (a < b) a = xpath_ipdom[a];
+        else b = xpath_ipdom[b];
+      }
+      a = (a == b) ? a : XPATH_SINK;
+    }
+    xpath_ipdom[i] = a;
+  }
+
+  xpath_stamp.assign(nckt, 0);
+  xpath_parent.assign(nckt, 0);
+  xpath_witness.assign(nckt, vector<int>());
+  xpath_generation = 0;
+}/* end of compute_xpath_dominators */
+
 
 /* Check if any D or D_bar reaches PO. Fig 7.4 */
 bool ATPG::check_test(void) {
@@ -510,36 +723,6 @@ bool ATPG::check_test(void) {
   return is_test;
 }/* end of check_test */
 
-/* exhaustive search of all nodes on the path from n to PO */
-void ATPG::mark_propagate_tree(const nptr n) {
-  int i,j,wnout,nnout;
-
-  if (n->flag & MARKED) return;
-    n->flag |= MARKED; // MARKED means this node is on the path to PO 
-  /* depth first search */
-  for (i = 0, wnout = n->owire.size(); i < wnout; i++) {
-    for (j = 0, nnout = n->owire[i]->onode.size(); j < nnout; j++) {
-      mark_propagate_tree(n->owire[i]->onode[j]);
-    }
-  }
-  return;
-}/* end of mark_propagate_tree */
-
-/* clear all the MARKS */ 
-void ATPG::unmark_propagate_tree(const nptr n) {
-  int i,j,wnout,nnout;
-
-  if (n->flag & MARKED) {
-    n->flag &= ~MARKED;
-    for (i = 0, wnout = n->owire.size(); i < wnout; i++) {
-      for (j = 0, nnout = n->owire[i]->onode.size(); j < nnout; j++) {
-        unmark_propagate_tree(n->owire[i]->onode[j]);
-      }
-    }
-  }
-  return;
-}/* end of unmark_propagate_tree */
-
 /* set the initial objective.  
  * returns TRUE if we can backtrace to a PI to assign
  * returns CONFLICT if it is impossible to achieve or set the initial objective*/
@@ -603,93 +786,55 @@ int ATPG::set_uniquely_implied_value(const fptr fault) {
 /*do a backward implication of the objective: set current_wire to desired_logic_value
  *implication means a natural consequence of the desired objective. 
  *returns TRUE if the backward implication reaches at least one PI 
- *returns FALSE if the backward implication reaches no PI */
+ *returns FALSE if the backward implication reaches no PI 
+ *returns CONFLICT if a PI is already assigned the other value
+ *
+ *depth first search on an explicit stack, so the depth of the circuit does
+ *not matter.  a (wire, value) pair already implied in this call is not
+ *implied again: through reconvergent fanout the same PIs would be reached */
 int ATPG::backward_imply(const wptr current_wire, const int& desired_logic_value) {
   int pi_is_reach = FALSE;
-  int i, nin;
+  int i, value, input_value;
+  wptr w;
+  nptr n;
 
-  nin = current_wire->inode.front()->iwire.size();
-  if (current_wire->flag & INPUT) { // if PI
-    if (current_wire->value != U &&  
-      current_wire->value != desired_logic_value) { 
-      return(CONFLICT); // conlict with previous assignment
+  backward_generation++;
+  backward_stack.clear();
+  backward_stack.push_back(make_pair(current_wire, desired_logic_value));
+  backward_stamp[2 * current_wire->wlist_index + desired_logic_value] = backward_generation;
+  while (!backward_stack.empty()) {
+    w = backward_stack.back().first;
+    value = backward_stack.back().second;
+    backward_stack.pop_back();
+
+    if (w->flag & INPUT) { // if PI
+      if (w->value != U && w->value != value) {
+        return(CONFLICT); // conlict with previous assignment
+      }
+      imply_assign(w, value); // assign PI to the objective value
+      pi_is_reach = TRUE;
+      continue;
     }
-    current_wire->value = desired_logic_value; // assign PI to the objective value
-    current_wire->flag |= CHANGED; 
-    // CHANGED means the logic value on this wire has recently been changed
-    return(TRUE);
-  }
-  else { // if not PI
-    switch (current_wire->inode.front()->type) {
-      /* assign NOT input opposite to its objective ouput */
-      /* go backward iteratively.  depth first search */
-      case NOT:
-        switch (backward_imply(current_wire->inode.front()->iwire.front(), (desired_logic_value ^ 1))) {
-          case TRUE: pi_is_reach = TRUE; break;
-          case CONFLICT: return(CONFLICT); break;
-          case FALSE: break;
-        }
-        break;
 
-		/* if objective is NAND output=zero, then NAND inputs are all ones  
-		 * keep doing this back implication iteratively  */
-      case NAND:
-        if (desired_logic_value == 0) {
-          for (i = 0; i < nin; i++) {
-            switch (backward_imply(current_wire->inode.front()->iwire[i],1)) {
-              case TRUE: pi_is_reach = TRUE; break;
-              case CONFLICT: return(CONFLICT); break;
-              case FALSE: break;
-            }
-          }
-        }
-        break;
-
-      case AND:
-        if (desired_logic_value == 1) {
-          for (i = 0; i < nin; i++) {
-            switch (backward_imply(current_wire->inode.front()->iwire[i],1)) {
-              case TRUE: pi_is_reach = TRUE; break;
-              case CONFLICT: return(CONFLICT); break;
-              case FALSE: break;
-            }
-          }
-        }
-        break;
-
-      case OR:
-        if (desired_logic_value == 0) {
-          for (i = 0; i < nin; i++) {
-            switch (backward_imply(current_wire->inode.front()->iwire[i],0)) {
-              case TRUE: pi_is_reach = TRUE; break;
-              case CONFLICT: return(CONFLICT); break;
-              case FALSE: break;
-            }
-          }
-        }
-        break;
-
-      case NOR:
-        if (desired_logic_value == 1) {
-          for (i = 0; i < nin; i++) {
-            switch (backward_imply(current_wire->inode.front()->iwire[i],0)) {
-              case TRUE: pi_is_reach = TRUE; break;
-              case CONFLICT: return(CONFLICT); break;
-              case FALSE: break;
-            }
-          }
-        }
-        break;
-
-      case BUF:
-        switch (backward_imply(current_wire->inode.front()->iwire.front(),desired_logic_value)) {
-          case TRUE: pi_is_reach = TRUE; break;
-          case CONFLICT: return(CONFLICT); break;
-          case FALSE: break;
-        }
-        break;
+    /* if not PI, the value implied on every gate input, if any */
+    n = w->inode.front();
+    switch (n->type) {
+      /* assign NOT input opposite to its objective ouput */
+      case NOT: input_value = value ^ 1; break;
+      case BUF: input_value = value; break;
+      /* if objective is NAND output=zero, then NAND inputs are all ones */
+      case NAND: if (value != 0) continue; input_value = 1; break;
+      case AND: if (value != 1) continue; input_value = 1; break;
+      case OR: if (value != 0) continue; input_value = 0; break;
+      case NOR: if (value != 1) continue; input_value = 0; break;
+      default: continue;
+    }
+    /* pushed backwards, so that the inputs are visited in order */
+    for (i = n->iwire.size() - 1; i >= 0; i--) {
+      if (backward_stamp[2 * n->iwire[i]->wlist_index + input_value] == backward_generation) continue;
+      backward_stamp[2 * n->iwire[i]->wlist_index + input_value] = backward_generation;
+      backward_stack.push_back(make_pair(n->iwire[i], input_value));
     }
-	
-    return(pi_is_reach);
   }
+  return(pi_is_reach);
 }/* end of backward_imply */
@@ -0,0 +1,187 @@
+/**********************************************************************/
+/*           Parallel-Pattern Single-Fault-Propagation (PPSFP)        */
+/*           Fault Simulator                                          */
+/*                                                                    */
+/*           64 patterns per pass, one bit per pattern in each rail   */
+/**********************************************************************/
+
+#include <queue>
+#include <functional>
+#include "atpg.h"
+
+/* pack 64 patterns into one block */
+#define num_of_block_pattern 64
+
+/* The wire values of 64 patterns are kept as two rails (see faultsim64.cpp),
+ * but here bit b stands for pattern b of the block instead of fault b:
+ *   one  : bit b set if the wire is logic one  under pattern b
+ *   zero : bit b set if the wire is logic zero under pattern b
+ * The good machine is simulated once per block (see goodsim.cpp).  Then every undetected
+ * fault is injected alone and propagated event by event through its fanout
+ * cone, for all 64 patterns at once, until the fault effect dies out.
+ *
+ * Vectors are processed from the last one to the first one, as in
+ * fault_simulate_vectors, and a fault detected by several patterns of a block
+ * is credited to the first of them in that order.  Therefore the report is
+ * the same as the one of the pattern-by-pattern simulator with fault dropping. */
+
+/* fault simulate all vectors, 64 patterns at a time */
+void ATPG::fault_simulate_vectors_ppsfp(int& total_detect_num) {
+  int i, hi, lo, nckt;
+  uint64_t valid, detected;
+  vector<int> detect_num;   // number of faults first detected by each vector
+  fptr f;
+
+  nckt = sort_wlist.size();
+  pattern_faulty_one.assign(nckt, ALL_ZERO64);
+  pattern_faulty_zero.assign(nckt, ALL_ZERO64);
+  detect_num.assign(patterns.size(), 0);
+
+  /* for every block of (at most) 64 vectors, from the last vector backwards.
+   * bit b of a rail is vector lo + b */
+  for (hi = patterns.size() - 1; hi >= 0; hi = lo - 1) {
+    lo = max(0, hi - num_of_block_pattern + 1);
+    valid = (hi - lo + 1 == num_of_block_pattern) ? ALL_ONE64 : ((1ULL << (hi - lo + 1)) - 1);
+
+    /* good machine */
+    good_sim_block(lo, hi - lo + 1);
+    for (i = 0; i < nckt; i++) {
+      pattern_faulty_one[i] = pattern_good_one[i];
+      pattern_faulty_zero[i] = pattern_good_zero[i];
+    }
+
+    /* single fault propagation for every undetected fault */
+    for (auto pos = flist_undetect.cbegin(); pos != flist_undetect.cend(); ++pos) {
+      f = *pos;
+      if (f->detect == REDUNDANT) { continue; } /* ignore redundant faults */
+      detected = ppsfp_simulate_fault(f) & valid;
+      if (detected) {
+        /* credit the first detecting vector in simulation order, the highest one */
+        f->detect = TRUE;
+        detect_num[lo + 63 - __builtin_clzll(detected)] += f->eqv_fault_num;
+      }
+    }
+
+    /* fault dropping  */
+    flist_undetect.remove_if(
+      [&](const fptr fptr_ele){
+        return (fptr_ele->detect == TRUE);
+      });
+
+    for (i = hi; i >= lo; i--) {
+      total_detect_num += detect_num[i];
+      fprintf(stdout,"vector[%d] detects %d faults (%d)\n",i,detect_num[i],total_detect_num);
+    }
+  } // for every block
+}/* end of fault_simulate_vectors_ppsfp */
+
+/* inject fault f, propagate it through its fanout cone for the 64 patterns
+ * of the block and return the set of patterns that detect it.
+ * the activation and gate input propagation rules follow fault_sim_a_vector */
+uint64_t ATPG::ppsfp_simulate_fault(const fptr f) {
+  wptr site, w;
+  nptr n;
+  int i, j, nin, idx;
+  uint64_t active, propagate, force_one, force_zero, side_zero, new_one, new_zero;
+  uint64_t detected = ALL_ZERO64;
+  /* wires to evaluate, popped in wlist_index (i.e. level) order */
+  priority_queue<int, vector<int>, greater<int> > event_queue;
+  vector<int> touched;   // wires whose faulty rails were changed
+
+  site = sort_wlist[f->to_swlist];
+
+  /* activated where the good value is not the stuck value (unknown included) */
+  if (f->fault_type == STUCK0) active = ~pattern_good_zero[f->to_swlist];
+  else active = ~pattern_good_one[f->to_swlist];
+  if (!active) return(ALL_ZERO64);
+
+  /* fault on a PO, detected as soon as it is activated */
+  if ((f->node->type == OUTPUT) || (f->io == GO && site->flag & OUTPUT)) {
+    return(active);
+  }
+
+  if (f->io == GO) {
+    /* the stuck value is forced on the fault site for every active pattern */
+    w = site;
+    force_one = (f->fault_type == STUCK1) ? active : ALL_ZERO64;
+    force_zero = (f->fault_type == STUCK0) ? active : ALL_ZERO64;
+  }
+  else {
+    /* gate input fault: the effect reaches the gate output only when all
+     * side inputs are non-controlling.  see get_faulty_wire */
+    n = f->node;
+    w = n->owire.front();
+    propagate = ALL_ONE64;
+    side_zero = ALL_ZERO64;
+    nin = n->iwire.size();
+    for (i = 0; i < nin; i++) {
+      if (n->iwire[i] == site) continue;
+      idx = n->iwire[i]->wlist_index;
+      switch (n->type) {
+        case AND:
+        case NAND: propagate &= pattern_good_one[idx]; break;
+        case OR:
+        case NOR: propagate &= pattern_good_zero[idx]; break;
+        case XOR:
+        case EQV: side_zero |= pattern_good_zero[idx]; break;
+      }
+    }
+    active &= propagate;
+    switch (n->type) {
+      case AND:
+      case NOR: force_one = active; force_zero = ALL_ZERO64; break;
+      case NAND:
+      case OR: force_one = ALL_ZERO64; force_zero = active; break;
+      /* a side input of 0 keeps the fault type, otherwise it is flipped */
+      case XOR:
+        force_one = active & ((f->fault_type == STUCK1) ? side_zero : ~side_zero);
+        force_zero = active & ~force_one;
+        break;
+      case EQV:
+        force_one = active & ((f->fault_type == STUCK1) ? ~side_zero : side_zero);
+        force_zero = active & ~force_one;
+        break;
+      default:
+        force_one = force_zero = ALL_ZERO64;
+        break;
+    }
+    if (!active) return(ALL_ZERO64);
+    if (w->flag & OUTPUT) return(active);
+  }
+
+  /* inject the fault on w and schedule its fanout */
+  idx = w->wlist_index;
+  pattern_faulty_one[idx] = (pattern_good_one[idx] & ~(force_one | force_zero)) | force_one;
+  pattern_faulty_zero[idx] = (pattern_good_zero[idx] & ~(force_one | force_zero)) | force_zero;
+  touched.push_back(idx);
+  for (j = fanout_start[idx]; j < fanout_start[idx + 1]; j++) {
+    event_queue.push(fanout_index[j]);
+  }
+
+  /* event-driven propagation; stops when the fault effect dies out */
+  while (!event_queue.empty()) {
+    idx = event_queue.top();
+    event_queue.pop();
+    while (!event_queue.empty() && (event_queue.top() == idx)) event_queue.pop();
+    pattern_sim_evaluate(idx, pattern_faulty_one, pattern_faulty_zero, new_one, new_zero);
+    if ((new_one == pattern_faulty_one[idx]) && (new_zero == pattern_faulty_zero[idx])) continue;
+    pattern_faulty_one[idx] = new_one;
+    pattern_faulty_zero[idx] = new_zero;
+    touched.push_back(idx);
+
+    /* a PO detects the fault where both values are known and different */
+    if (sort_wlist[idx]->flag & OUTPUT) {
+      detected |= (new_one & pattern_good_zero[idx]) | (new_zero & pattern_good_one[idx]);
+    }
+    for (j = fanout_start[idx]; j < fanout_start[idx + 1]; j++) {
+      event_queue.push(fanout_index[j]);
+    }
+  }
+
+  /* restore the fault-free rails */
+  for (int t: touched) {
+    pattern_faulty_one[t] = pattern_good_one[t];
+    pattern_faulty_zero[t] = pattern_good_zero[t];
+  }
+  return(detected);
+}/* end of ppsfp_simulate_fault */
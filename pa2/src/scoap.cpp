@@ -0,0 +1,103 @@
+/**********************************************************************/
+/*           SCOAP testability measures for the podem heuristics      */
+/*                                                                    */
+/*           combinational controllability and observability          */
+/**********************************************************************/
+
+#include "atpg.h"
+
+/* the measures of a large circuit grow very fast through reconvergent
+ * fanout, so every sum saturates at scoap_limit */
+#define scoap_limit 1000000000
+
+static inline int scoap_add(const int& a, const int& b) {
+  return (a >= scoap_limit - b) ? scoap_limit : a + b;
+}
+
+/* Compute the SCOAP measures of every wire on the compiled netlist:
+ *   cc0[i], cc1[i] cost of setting wire i to 0 / 1 (1 for a PI)
+ *   co[i]          cost of observing wire i on a PO (0 for a PO)
+ * cc0/cc1 are computed in sort_wlist order, co in the reverse order.  A stem
+ * takes the cheapest of its branches.  podem uses them to choose the gate
+ * input to backtrace to and the D-frontier gate to propagate through. */
+void ATPG::compute_scoap(void) {
+  int i, j, k, begin, end, nckt, cost, side;
+
+  nckt = sort_wlist.size();
+  cc0.assign(nckt, 1);
+  cc1.assign(nckt, 1);
+  co.assign(nckt, scoap_limit);
+
+  for (i = cktin.size(); i < nckt; i++) {
+    begin = fanin_start[i];
+    end = fanin_start[i + 1];
+    switch (gate_type[i]) {
+      case AND:
+      case NAND:
+      case OR:
+      case NOR:
+        /* c: the cost of one input at the controlling value,
+         * n: the cost of all inputs at the non-controlling value */
+        {
+          int c = scoap_limit, n = 0;
+          bool and_type = (gate_type[i] == AND || gate_type[i] == NAND);
+          for (j = begin; j < end; j++) {
+            k = fanin_index[j];
+            c = min(c, and_type ? cc0[k] : cc1[k]);
+            n = scoap_add(n, and_type ? cc1[k] : cc0[k]);
+          }
+          c = scoap_add(c, 1);
+          n = scoap_add(n, 1);
+          switch (gate_type[i]) {
+            case AND:  cc0[i] = c; cc1[i] = n; break;
+            case NAND: cc0[i] = n; cc1[i] = c; break;
+            case OR:   cc0[i] = n; cc1[i] = c; break;
+            case NOR:  cc0[i] = c; cc1[i] = n; break;
+          }
+        }
+        break;
+      case NOT:
+        cc0[i] = scoap_add(cc1[fanin_index[begin]], 1);
+        cc1[i] = scoap_add(cc0[fanin_index[begin]], 1);
+        break;
+      case BUF:
+        cc0[i] = scoap_add(cc0[fanin_index[begin]], 1);
+        cc1[i] = scoap_add(cc1[fanin_index[begin]], 1);
+        break;
+      case XOR:
+      case EQV:
+        j = fanin_index[begin];
+        k = fanin_index[begin + 1];
+        cc0[i] = scoap_add(min(scoap_add(cc0[j], cc0[k]), scoap_add(cc1[j], cc1[k])), 1);
+        cc1[i] = scoap_add(min(scoap_add(cc0[j], cc1[k]), scoap_add(cc1[j], cc0[k])), 1);
+        if (gate_type[i] == EQV) swap(cc0[i], cc1[i]);
+        break;
+    }
+  }
+
+  for (i = nckt - 1; i >= 0; i--) {
+    if (sort_wlist[i]->flag & OUTPUT) co[i] = 0;
+    if (i < cktin.size()) continue;
+    begin = fanin_start[i];
+    end = fanin_start[i + 1];
+    /* an input is observed through wire i when the other inputs are set
+     * to the non-controlling value (to any value for XOR/EQV) */
+    for (j = begin; j < end; j++) {
+      cost = scoap_add(co[i], 1);
+      for (k = begin; k < end; k++) {
+        if (k == j) continue;
+        switch (gate_type[i]) {
+          case AND:
+          case NAND: side = cc1[fanin_index[k]]; break;
+          case OR:
+          case NOR:  side = cc0[fanin_index[k]]; break;
+          case XOR:
+          case EQV:  side = min(cc0[fanin_index[k]], cc1[fanin_index[k]]); break;
+          default:   side = 0; break;
+        }
+        cost = scoap_add(cost, side);
+      }
+      co[fanin_index[j]] = min(co[fanin_index[j]], cost);
+    }
+  }
+}/* end of compute_scoap */
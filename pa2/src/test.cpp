@@ -1,7 +1,10 @@
 #include "atpg.h"
 
+/* pack 64 patterns into one block */
+#define num_of_block_pattern 64
+
 void ATPG::test(void) {
-  string vec;
+  int i, p;
   int current_detect_num = 0;
   int total_detect_num = 0;
   int total_no_of_backtracks = 0;  // accumulative number of backtracks
@@ -9,33 +12,65 @@ void ATPG::test(void) {
   int no_of_aborted_faults = 0;
   int no_of_redundant_faults = 0;
   int no_of_calls = 0;
+  int no_of_packed_faults = 0;  // secondary faults added to the vectors by dynamic compaction
+  int no_of_random_vectors = 0;
+
+  fptr fault_under_test;
 
-  fptr fault_under_test = flist_undetect.front();
+  /* good machine simulation only mode, see goodsim.cpp */
+  if (gsim_only) {
+    good_simulate_vectors();
+    return;
+  }
 
   /* Fsim only mode */
   if(fsim_only)
   {
     fault_simulate_vectors(total_detect_num);
-    in_vector_no+=vectors.size();
+    in_vector_no+=patterns.size();
+    stop_fsim_workers();
     display_undetect();
     fprintf(stdout,"\n");
     return;
   }// if fsim only
 
   /* ATPG mode */
+  /* the generated vectors are kept in the pattern store */
+  patterns.reset(cktin.size());
+
+  /* the faults that random vectors detect easily are not given to podem */
+  if ((random_limit > 0) && (total_attempt_num == 1)) {
+    random_pattern_phase(total_detect_num, no_of_random_vectors);
+  }
+
+  /* the faults still undetected, in the order podem takes them */
+  build_fault_worklist();
+  fault_under_test = next_fault();
+
   /* Figure 5 in the PODEM paper */
   while(fault_under_test != nullptr) {
     switch(podem(fault_under_test,current_backtracks)) {
       case TRUE:
+        /* add more faults to the unassigned PIs before the random fill */
+        if ((compaction_limit > 0) && (total_attempt_num == 1)) {
+          compact_test_cube(fault_under_test, no_of_packed_faults);
+        }
+        /* with static compaction, only the vectors kept are printed */
+        if ((total_attempt_num == 1) && !static_compaction) display_io();
         /* form a vector */
-        vec.clear();
-        for (wptr w: cktin) {
-          vec.push_back(itoc(w->value));
+        p = patterns.add();
+        patterns.set_target(p, fault_under_test->fault_no);
+        for (i = 0; i < cktin.size(); i++) {
+          switch (cktin[i]->value) {
+            case D: patterns.set(p, i, 1); break;
+            case B: patterns.set(p, i, 0); break;
+            default: patterns.set(p, i, cktin[i]->value); break;
+          }
         }
         /*by defect, we want only one pattern per fault */
         /*run a fault simulation, drop ALL detected faults */
         if (total_attempt_num == 1) {
-          fault_sim_a_vector(vec, current_detect_num);
+          fault_sim_a_vector(p, current_detect_num);
           total_detect_num += current_detect_num;
         }
         /* If we want mutiple petterns per fault, 
@@ -57,17 +92,22 @@ void ATPG::test(void) {
         break;
     }
     fault_under_test->test_tried = true;
-    fault_under_test = nullptr;
-    for (fptr fptr_ele: flist_undetect) {
-      if (!fptr_ele->test_tried) {
-        fault_under_test = fptr_ele;
-        break;
-      }
-    }
+    fault_under_test = next_fault();
     total_no_of_backtracks += current_backtracks; // accumulate number of backtracks
     no_of_calls++;
   }
 
+  stop_fsim_workers();
+
+  /* drop the vectors not needed for the coverage and print the others */
+  if (static_compaction && (total_attempt_num == 1)) {
+    compact_patterns();
+    in_vector_no = patterns.size();
+    for (p = 0; p < patterns.size(); p++) display_pattern(p);
+  }
+  if (!pattern_file.empty() && !patterns.write(pattern_file)) {
+    fprintf(stderr,"File %s could not be written\n",pattern_file.c_str());
+  }
   display_undetect();
   fprintf(stdout,"\n");
   fprintf(stdout,"#number of aborted faults = %d\n",no_of_aborted_faults);
@@ -77,4 +117,167 @@ void ATPG::test(void) {
   fprintf(stdout,"#number of calling podem1 = %d\n",no_of_calls);
   fprintf(stdout,"\n");
   fprintf(stdout,"#total number of backtracks = %d\n",total_no_of_backtracks);
+  if (compaction_limit > 0) {
+    fprintf(stdout,"\n");
+    fprintf(stdout,"#number of faults added by dynamic compaction = %d\n",no_of_packed_faults);
+  }
+  if (random_limit > 0) {
+    fprintf(stdout,"\n");
+    fprintf(stdout,"#number of random vectors = %d\n",no_of_random_vectors);
+  }
 }/* end of test */
+
+/* dynamic compaction.  podem found a test cube for primary, and its PIs
+ * that are still U can test more faults: the next untried faults of
+ * flist_undetect are given to podem with the cube held (see test_cube), at
+ * most compaction_limit of them, and each test found is merged into the
+ * cube.  a fault that fails here is not marked, it gets its own podem call
+ * later.  the remaining U PIs are random filled and the vector is left on
+ * cktin, as podem does for a single fault */
+void ATPG::compact_test_cube(const fptr primary, int& num_of_packed) {
+  int i, ncktin, num_of_free, num_of_tried, backtracks;
+
+  ncktin = cktin.size();
+  test_cube.resize(ncktin);
+  num_of_free = 0;
+  for (i = 0; i < ncktin; i++) {
+    switch (cktin[i]->value) {
+      case D: test_cube[i] = 1; break;
+      case B: test_cube[i] = 0; break;
+      default: test_cube[i] = cktin[i]->value; break;
+    }
+    if (test_cube[i] == U) num_of_free++;
+  }
+
+  num_of_tried = 0;
+  for (fptr f: flist_undetect) {
+    if ((num_of_free == 0) || (num_of_tried == compaction_limit)) break;
+    if ((f == primary) || f->test_tried || (f->detect == REDUNDANT)) continue;
+    num_of_tried++;
+    if (podem(f, backtracks) != TRUE) continue;
+    /* a test for f with the cube held: take its new PI values */
+    for (i = 0; i < ncktin; i++) {
+      if (test_cube[i] != U) continue;
+      switch (cktin[i]->value) {
+        case 0:
+        case B: test_cube[i] = 0; num_of_free--; break;
+        case 1:
+        case D: test_cube[i] = 1; num_of_free--; break;
+      }
+    }
+    num_of_packed++;
+  }
+
+  for (i = 0; i < ncktin; i++) {
+    cktin[i]->value = (test_cube[i] == U) ? (rand()&01) : test_cube[i]; // random fill U
+  }
+  test_cube.clear();
+}/* end of compact_test_cube */
+
+/* random pattern phase before podem.  blocks of 64 random vectors are
+ * fault simulated by the PPSFP simulator (ppsfp.cpp) with fault dropping,
+ * until a block detects fewer than random_limit faults.  a fault detected by
+ * several vectors of a block is credited to the first of them, and the
+ * vectors credited with no fault are dropped.  the others stay in the
+ * pattern store and are printed; num_of_random counts them */
+void ATPG::random_pattern_phase(int& total_detect_num, int& num_of_random) {
+  int i, b, p, lo, nckt, ncktin, num_of_detect;
+  uint64_t detected, credited;
+  vector<uint64_t> mask;  // the vectors to keep, see PATTERN_STORE::keep
+
+  nckt = sort_wlist.size();
+  ncktin = cktin.size();
+  pattern_faulty_one.assign(nckt, ALL_ZERO64);
+  pattern_faulty_zero.assign(nckt, ALL_ZERO64);
+
+  do {
+    /* a block of random vectors at the end of the store */
+    lo = patterns.size();
+    for (b = 0; b < num_of_block_pattern; b++) {
+      p = patterns.add();
+      for (i = 0; i < ncktin; i++) patterns.set(p, i, rand()&01);
+    }
+    good_sim_block(lo, num_of_block_pattern);
+    for (i = 0; i < nckt; i++) {
+      pattern_faulty_one[i] = pattern_good_one[i];
+      pattern_faulty_zero[i] = pattern_good_zero[i];
+    }
+
+    num_of_detect = 0;
+    credited = ALL_ZERO64;
+    for (fptr f: flist_undetect) {
+      detected = ppsfp_simulate_fault(f);
+      if (!detected) continue;
+      f->detect = TRUE;
+      credited |= detected & (~detected + 1);  // the lowest bit, the first vector
+      num_of_detect++;
+      total_detect_num += f->eqv_fault_num;
+    }
+
+    /* fault dropping  */
+    flist_undetect.remove_if(
+      [&](const fptr fptr_ele){
+        return (fptr_ele->detect == TRUE);
+      });
+
+    /* keep the vectors before the block and the credited ones of it */
+    mask.assign((lo + num_of_block_pattern + 63) >> 6, ALL_ONE64);
+    for (b = 0; b < num_of_block_pattern; b++) {
+      if (!((credited >> b) & 1)) mask[(lo + b) >> 6] &= ~(1ULL << ((lo + b) & 63));
+    }
+    patterns.keep(mask);
+    for (p = lo; p < patterns.size(); p++) {
+      if (!static_compaction) display_pattern(p);
+      in_vector_no++;
+      num_of_random++;
+    }
+  } while ((num_of_detect >= random_limit) && !flist_undetect.empty());
+}/* end of random_pattern_phase */
+
+/* put the undetected faults in the order given by fault_order:
+ *   FAULT_ORDER_LIST  the order of flist_undetect, which is by increasing
+ *                     level of the fault site (see generate_fault_list)
+ *   FAULT_ORDER_LEVEL decreasing level of the fault site, from the POs
+ *   FAULT_ORDER_SCOAP decreasing SCOAP cost, the cost of setting the fault
+ *                     site to the opposite of the stuck value and observing it
+ * ties keep the order of flist_undetect */
+void ATPG::build_fault_worklist(void) {
+  vector<long long> cost;
+
+  fault_worklist.assign(flist_undetect.begin(), flist_undetect.end());
+  worklist_next = 0;
+  switch (fault_order) {
+    case FAULT_ORDER_LEVEL:
+      stable_sort(fault_worklist.begin(), fault_worklist.end(),
+        [&](const fptr a, const fptr b){
+          return (sort_wlist[a->to_swlist]->level > sort_wlist[b->to_swlist]->level);
+        });
+      break;
+    case FAULT_ORDER_SCOAP:
+      /* indexed by fault_no */
+      for (fptr f: fault_worklist) {
+        if (f->fault_no >= cost.size()) cost.resize(f->fault_no + 1);
+        cost[f->fault_no] = (long long) ((f->fault_type == STUCK0) ? cc1[f->to_swlist] : cc0[f->to_swlist]) +
+                            co[f->to_swlist];
+      }
+      stable_sort(fault_worklist.begin(), fault_worklist.end(),
+        [&](const fptr a, const fptr b){
+          return (cost[a->fault_no] > cost[b->fault_no]);
+        });
+      break;
+  }
+}/* end of build_fault_worklist */
+
+/* the next fault of the worklist that is neither detected nor tried.  a
+ * fault passed over never comes back, so over the whole run every fault
+ * is looked at once, whatever the fault dropping does to flist_undetect */
+ATPG::fptr ATPG::next_fault(void) {
+  fptr f;
+
+  while (worklist_next < fault_worklist.size()) {
+    f = fault_worklist[worklist_next];
+    if ((f->detect != TRUE) && !f->test_tried) return(f);
+    worklist_next++;
+  }
+  return(nullptr);
+}/* end of next_fault */
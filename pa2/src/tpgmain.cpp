@@ -33,6 +33,11 @@ main(int argc, char *argv[]) {
       atpg.set_fsim_only(true);
       i+=2;
     }
+    else if (strcmp(argv[i],"-gsim") == 0) {
+      vetFile = string(argv[i+1]);
+      atpg.set_gsim_only(true);
+      i+=2;
+    }
     else if (strcmp(argv[i],"-ndet") == 0) {
       if (atoi(argv[i+1]) < 1) {
         fprintf(stderr, "atpg: ndet should >= 1\n");
@@ -41,6 +46,69 @@ main(int argc, char *argv[]) {
       atpg.set_ndet(atoi(argv[i+1]));
       i+=2;
     }
+    else if (strcmp(argv[i],"-ppsfp") == 0) {
+      atpg.set_ppsfp(true);
+      i++;
+    }
+    else if (strcmp(argv[i],"-threads") == 0) {
+      if (atoi(argv[i+1]) < 1) {
+        fprintf(stderr, "atpg: number of threads should >= 1\n");
+        usage();
+      }
+      atpg.set_num_of_threads(atoi(argv[i+1]));
+      i+=2;
+    }
+    else if (strcmp(argv[i],"-compiled") == 0) {
+      atpg.set_compiled_sim(true);
+      i++;
+    }
+    else if (strcmp(argv[i],"-nocache") == 0) {
+      atpg.set_circuit_cache(false);
+      i++;
+    }
+    else if (strcmp(argv[i],"-bpat") == 0) {
+      atpg.set_pattern_file(string(argv[i+1]));
+      i+=2;
+    }
+    else if (strcmp(argv[i],"-compact") == 0) {
+      if (atoi(argv[i+1]) < 0) {
+        fprintf(stderr, "atpg: number of secondary faults should >= 0\n");
+        usage();
+      }
+      atpg.set_compaction_limit(atoi(argv[i+1]));
+      i+=2;
+    }
+    else if (strcmp(argv[i],"-scompact") == 0) {
+      atpg.set_static_compaction(true);
+      i++;
+    }
+    else if (strcmp(argv[i],"-random") == 0) {
+      if (atoi(argv[i+1]) < 0) {
+        fprintf(stderr, "atpg: number of faults per random block should >= 0\n");
+        usage();
+      }
+      atpg.set_random_limit(atoi(argv[i+1]));
+      i+=2;
+    }
+    else if (strcmp(argv[i],"-order") == 0) {
+      if (strcmp(argv[i+1],"list") == 0) atpg.set_fault_order(FAULT_ORDER_LIST);
+      else if (strcmp(argv[i+1],"level") == 0) atpg.set_fault_order(FAULT_ORDER_LEVEL);
+      else if (strcmp(argv[i+1],"scoap") == 0) atpg.set_fault_order(FAULT_ORDER_SCOAP);
+      else {
+        fprintf(stderr, "atpg: fault order should be list, level or scoap\n");
+        usage();
+      }
+      i+=2;
+    }
+    else if (strcmp(argv[i],"-packet") == 0) {
+      if ((atoi(argv[i+1]) != 16) && (atoi(argv[i+1]) != 64) &&
+          (atoi(argv[i+1]) != 256) && (atoi(argv[i+1]) != 512)) {
+        fprintf(stderr, "atpg: packet size should be 16, 64, 256 or 512\n");
+        usage();
+      }
+      atpg.set_packet_size(atoi(argv[i+1]));
+      i+=2;
+    }
     else if (argv[i][0] == '-') {
       j = 1;
       while (argv[i][j] != '\0') {
@@ -63,27 +131,55 @@ main(int argc, char *argv[]) {
 /* an input file was not specified, so describe the proper usage */
   if (inpFile.empty()) { usage(); }
 
+/* map the cached circuit and fault list, if the cache is up to date */
+  if (atpg.load_circuit_cache(inpFile)) { // cache.cpp
+    atpg.timer(stdout,"for loading circuit cache");
+  }
+  else {
 /* read in and parse the input file */
-  atpg.input(inpFile); // input.cpp
+    atpg.input(inpFile); // input.cpp
+    atpg.timer(stdout,"for reading in circuit");
+    
+    atpg.level_circuit();  // level.cpp
+    atpg.timer(stdout,"for levelling circuit");
+    
+    atpg.rearrange_gate_inputs();  //level.cpp
+    atpg.timer(stdout,"for rearranging gate inputs");
+    
+    atpg.create_dummy_gate(); //init_flist.cpp
+    atpg.timer(stdout,"for creating dummy nodes");
+    
+    atpg.pack_circuit(); //netlist.cpp
+    atpg.timer(stdout,"for packing circuit");
+    
+    atpg.generate_fault_list(); //init_flist.cpp
+    atpg.timer(stdout,"for generating fault list");
+    
+    atpg.save_circuit_cache(); // cache.cpp
+    atpg.timer(stdout,"for writing circuit cache");
+  }
 
 /* if vector file is provided, read it */
-  if(!vetFile.empty()) { atpg.read_vectors(vetFile); }
-  atpg.timer(stdout,"for reading in circuit");
+  if(!vetFile.empty()) {
+    atpg.read_vectors(vetFile);
+    atpg.timer(stdout,"for reading in vectors");
+  }
   
-  atpg.level_circuit();  // level.cpp
-  atpg.timer(stdout,"for levelling circuit");
+  atpg.compile_netlist(); //netlist.cpp
+  atpg.timer(stdout,"for compiling netlist");
   
-  atpg.rearrange_gate_inputs();  //level.cpp
-  atpg.timer(stdout,"for rearranging gate inputs");
+  atpg.compute_scoap(); //scoap.cpp
+  atpg.timer(stdout,"for computing SCOAP measures");
   
-  atpg.create_dummy_gate(); //init_flist.cpp
-  atpg.timer(stdout,"for creating dummy nodes");
+  atpg.compute_fanout_cones(); //cone.cpp
+  atpg.timer(stdout,"for computing fanout cones");
   
-  atpg.generate_fault_list(); //init_flist.cpp
-  atpg.timer(stdout,"for generating fault list");
+  if (atpg.load_compiled_sim()) { // compiled.cpp
+    atpg.timer(stdout,"for loading compiled simulation code");
+  }
   
   atpg.test(); //test.cpp
-  atpg.compute_fault_coverage(); //init_flist.cpp
+  if (!atpg.get_gsim_only()) atpg.compute_fault_coverage(); //init_flist.cpp
   atpg.timer(stdout,"for test pattern generation");
   exit(EXIT_SUCCESS);
 }
@@ -93,40 +189,56 @@ void usage(void) {
    fprintf(stderr, "usage: atpg [options] infile\n");
    fprintf(stderr, "Options\n");
    fprintf(stderr, "    -fsim <filename>: fault simulation only; filename provides vectors\n");
+   fprintf(stderr, "    -gsim <filename>: good machine simulation only; print the PO response of every vector\n");
+   fprintf(stderr, "    -ppsfp: with -fsim, simulate 64 patterns at a time (PPSFP)\n");
+   fprintf(stderr, "    -threads <num>: <num> threads share the fault list in fault simulation\n");
    fprintf(stderr, "    -anum <num>: <num> specifies number of vectors per fault\n");
    fprintf(stderr, "    -bt <num>: <num> specifies number of backtracks\n");
+   fprintf(stderr, "    -packet <num>: <num> faults per fault simulation packet (16, 64, 256 or 512)\n");
+   fprintf(stderr, "    -nocache: neither read nor write the binary circuit cache infile.bin\n");
+   fprintf(stderr, "    -compiled: run -gsim and -ppsfp on C++ code generated for the circuit (infile.so)\n");
+   fprintf(stderr, "    -bpat <filename>: also write the generated vectors to filename in binary\n");
+   fprintf(stderr, "    -compact <num>: try up to <num> more faults on the unassigned inputs of each vector\n");
+   fprintf(stderr, "    -scompact: drop the vectors not needed for the fault coverage after ATPG\n");
+   fprintf(stderr, "    -random <num>: random vectors before podem, until 64 of them detect fewer than <num> faults\n");
+   fprintf(stderr, "    -order <list|level|scoap>: podem takes the faults in list order, from the POs, or hardest (SCOAP) first\n");
    exit(EXIT_FAILURE);
 
 } /* end of usage() */
 
 
+/* read vetFile into the pattern store.  a binary pattern file (see
+ * pattern.cpp) is loaded as is.  the T'...' lines of a text file are read
+ * line by line through one reused buffer, so only the packed patterns are
+ * kept in memory */
 void ATPG::read_vectors(const string& vetFile) {
-  string t, vec;
-  size_t i;
+  FILE *file;
+  char *line = nullptr;
+  size_t capacity = 0;
+  ssize_t len;
   
-  ifstream file(vetFile, std::ifstream::in); // open the input vectors' file
-  if(!file) { // if the ifstream obj does not exist, fail to open the file
+  if (patterns.read(vetFile)) { // binary pattern file
+    if (patterns.inputs() != cktin.size()) {
+      fprintf(stderr,"File %s has vectors of %d inputs, but the circuit has %d\n",
+              vetFile.c_str(), patterns.inputs(), (int) cktin.size());
+      exit(EXIT_FAILURE);
+    }
+    return;
+  }
+  
+  file = fopen(vetFile.c_str(), "r"); // open the input vectors' file
+  if (file == nullptr) { // fail to open the file
     fprintf(stderr,"File %s could not be opened\n",vetFile.c_str());
     exit(EXIT_FAILURE);
   }
   
-  while(!file.eof() && !file.bad()) {
-    getline(file, t); // get a line from the file
-    if(t[0] != 'T') continue; // if this line is not a vector, ignore it
-    else {
-      vec.clear();
-      for (char c: t) {
-        if (c == 'T') continue;  // ignore "T"
-        if (c == '\'') continue; // ignore "'"
-        if (c == ' ') continue;  // ignore " "
-        vec.push_back(c);
-      }
-      //cout << "Before erase: " << t << endl;
-      //cout << "After erase: " << vec << endl;
-      vectors.push_back(vec); // append the vectors
-    }
+  patterns.reset(cktin.size());
+  while ((len = getline(&line, &capacity, file)) != -1) {
+    if (line[0] != 'T') continue; // if this line is not a vector, ignore it
+    patterns.add(line, line + len); // append the vector
   }
-  file.close(); // close the file
+  free(line);
+  fclose(file); // close the file
 }
 
 void ATPG::set_fsim_only(const bool& b) {
@@ -144,3 +256,47 @@ void ATPG::set_backtrack_limit(const int& i) {
 void ATPG::set_ndet(const int& i) {
   this->ndet = i;
 }
+
+void ATPG::set_packet_size(const int& i) {
+  this->packet_size = i;
+}
+
+void ATPG::set_ppsfp(const bool& b) {
+  this->ppsfp = b;
+}
+
+void ATPG::set_num_of_threads(const int& i) {
+  this->num_of_threads = i;
+}
+
+void ATPG::set_circuit_cache(const bool& b) {
+  this->use_circuit_cache = b;
+}
+
+void ATPG::set_pattern_file(const string& s) {
+  this->pattern_file = s;
+}
+
+void ATPG::set_gsim_only(const bool& b) {
+  this->gsim_only = b;
+}
+
+void ATPG::set_compiled_sim(const bool& b) {
+  this->use_compiled_sim = b;
+}
+
+void ATPG::set_compaction_limit(const int& i) {
+  this->compaction_limit = i;
+}
+
+void ATPG::set_static_compaction(const bool& b) {
+  this->static_compaction = b;
+}
+
+void ATPG::set_random_limit(const int& i) {
+  this->random_limit = i;
+}
+
+void ATPG::set_fault_order(const int& i) {
+  this->fault_order = i;
+}
@@ -14,12 +14,22 @@ ATPG::ATPG() {
   this->total_attempt_num = 1;    /* default value */
   this->fsim_only = false;        /* flag to indicate fault simulation only */
   this->tdfsim_only = false;        /* flag to indicate tdfault simulation only */
+  this->packet_size = 16;         /* faults per fault simulation packet */
+  this->rail_words = 0;           /* dual-rail storage is allocated on first use */
+  this->fault_sim_kernel = nullptr;
+  this->num_of_threads = 1;       /* single-threaded fault simulation */
+  this->use_circuit_cache = true; /* keep a binary image of the circuit next to it */
+  this->fsim_job = nullptr;
+  this->fsim_generation = 0;
+  this->fsim_pending = 0;
+  this->fsim_quit = false;
 
   /* orginally assigned in input.c */
   this->debug = 0;                /* != 0 if debugging;  this is a switch of debug mode */
   this->lineno = 0;               /* current line number */
   this->targc = 0;                /* number of args on current command line */
   this->file_no = 0;              /* number of current file */
+  this->num_input_node = 0;
   
   /* orginally assigned in init_flist.c */
   this->num_of_gate_fault = 0; // totle number of faults in the whole circuit
@@ -28,14 +38,16 @@ ATPG::ATPG() {
   this->in_vector_no = 0;         /* number of test vectors generated */
 }
 
+/* constructor of NAME_TABLE */
+ATPG::NAME_TABLE::NAME_TABLE() {
+  this->num_of_entry = 0;
+}
+
 /* constructor of WIRE */
 ATPG::WIRE::WIRE() {
   this->value = 0;
   this->flag = 0;
   this->level = 0;
-  this->wire_value1 = 0;
-  this->wire_value2 = 0;
-  this->fault_flag = 0;
   this->wlist_index = 0;
 }
 
@@ -40,18 +40,20 @@ void ATPG::display_line(fptr fault) {
 */
 void ATPG::display_io(void) {
   int i;
+  string line("T\'");
 
-  fprintf(stdout,"T\'");
+  /* build the whole vector and print it at once */
   for (i = 0; i < cktin.size(); i++) {
     switch (cktin[i]->value) {
-      case 0: fprintf(stdout,"0"); break;
-      case 1: fprintf(stdout,"1"); break;
-      case U: fprintf(stdout,"x"); break;
-      case D: fprintf(stdout,"1"); break;
-      case B: fprintf(stdout,"0"); break;
+      case 0: line.push_back('0'); break;
+      case 1: line.push_back('1'); break;
+      case U: line.push_back('x'); break;
+      case D: line.push_back('1'); break;
+      case B: line.push_back('0'); break;
     }
   }
-  fprintf(stdout,"'");
+  line.push_back('\'');
+  fputs(line.c_str(), stdout);
 
   fprintf(stdout," ");
   for (i = 0; i < cktout.size(); i++) {
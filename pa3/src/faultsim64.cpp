@@ -0,0 +1,579 @@
+/**********************************************************************/
+/*           Dual-Rail Parallel-Fault Event-Driven Fault Simulator    */
+/*                                                                    */
+/*           64, 256 or 512 faults per packet, one bit per fault      */
+/**********************************************************************/
+
+#include "atpg.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_KERNELS
+#endif
+
+/* at most 512 faults (eight 64-bit words per rail) in one packet */
+#define max_fault_slot 512
+#define max_rail_words 8
+
+/* Every wire carries two rails instead of the 2-bit-per-fault word
+ * used by fault_sim_a_vector:
+ *   one  : bit i set if the wire may be logic one  in the presence of fault i
+ *   zero : bit i set if the wire may be logic zero in the presence of fault i
+ * so that 1 = (1,0), 0 = (0,1) and unknown = (0,0).
+ * With this encoding a gate is evaluated with plain AND/OR operations
+ * and an inversion is a swap of the two rails.
+ * A rail is rail_words 64-bit words long; the faulty rails of wire w are
+ * stored at [w->wlist_index * rail_words, (w->wlist_index + 1) * rail_words).
+ * The good rails are the same for every fault, one word per wire is enough.
+ *
+ * The faulty machine lives in a FSIM_CONTEXT.  With -threads n the
+ * undetected faults are split into n contiguous parts, and each part is
+ * simulated in its own context by its own thread (see fsim_thread.cpp).
+ * The faults are independent of each other, so the detected faults are
+ * the same whatever the partition is. */
+
+/* fault simulate a single test vector, packet_size faults per packet */
+void ATPG::fault_sim_a_vector64(const int& p, int& num_of_current_detect) {
+  int i, nckt;
+
+  /* num_of_current_detect is used to keep track of the number of undetected
+   * faults detected by this vector, initialize it to zero */
+  num_of_current_detect = 0;
+
+  /* for every input, set its value to the current vector value */
+  for(i = 0; i < cktin.size(); i++) {
+    cktin[i]->value = patterns.get(p, i);
+  }
+
+  /* initialize the circuit - mark all inputs as changed and all other
+   * nodes as unknown (2) */
+  nckt = sort_wlist.size();
+  for (i = 0; i < nckt; i++) {
+    if (i < cktin.size()) {
+      sort_wlist[i]->flag |= CHANGED;
+    }
+    else {
+      sort_wlist[i]->value = U;
+    }
+  }
+
+  sim(); /* do a fault-free simulation, see sim.c */
+  if (debug) { display_io(); }
+
+  setup_fault_sim64();
+  partition_fault_list();
+  run_fsim_job(&ATPG::fault_sim_packets64);
+
+  /* fault dropping  */
+  flist_undetect.remove_if(
+    [&](const fptr fptr_ele){
+      if (fptr_ele->detect == TRUE) {
+        num_of_current_detect += fptr_ele->eqv_fault_num;
+        return true;
+      }
+      else {
+        return false;
+      }
+    });
+}/* end of fault_sim_a_vector64 */
+
+/* allocate the rails and the thread contexts once, then expand the
+ * fault-free 0,1,2 value of every wire into the two good rails.
+ * a packet is at least 64 faults wide, -threads with the default
+ * 16-fault packet simulates 64 faults per packet */
+void ATPG::setup_fault_sim64(void) {
+  int i, nckt;
+
+  nckt = sort_wlist.size();
+  if ((good_one.size() != nckt) || (rail_words != max(1, packet_size / 64)) ||
+      (fsim_context.size() != num_of_threads)) {
+    rail_words = max(1, packet_size / 64);
+    good_one.assign(nckt, ALL_ZERO64);
+    good_zero.assign(nckt, ALL_ZERO64);
+    fsim_context.assign(num_of_threads, FSIM_CONTEXT());
+    for (FSIM_CONTEXT& ctx: fsim_context) {
+      ctx.faulty_one.assign(nckt * rail_words, ALL_ZERO64);
+      ctx.faulty_zero.assign(nckt * rail_words, ALL_ZERO64);
+      ctx.inject_mask.assign(nckt * rail_words, ALL_ZERO64);
+      ctx.flag.assign(nckt, 0);
+    }
+    select_fault_sim_kernel();
+    start_fsim_workers();
+  }
+
+  for (i = 0; i < nckt; i++) {
+    switch (sort_wlist[i]->value) {
+      case 1: good_one[i] = ALL_ONE64;  good_zero[i] = ALL_ZERO64; break;
+      case 2: good_one[i] = ALL_ZERO64; good_zero[i] = ALL_ZERO64; break;
+      case 0: good_one[i] = ALL_ZERO64; good_zero[i] = ALL_ONE64;  break;
+    }
+  } // for i
+}/* end of setup_fault_sim64 */
+
+/* split the undetected faults into num_of_threads contiguous parts of
+ * about the same size.  redundant faults are never simulated */
+void ATPG::partition_fault_list(void) {
+  int num_of_fault, t, part;
+
+  num_of_fault = 0;
+  for (fptr f: flist_undetect) {
+    if (f->detect != REDUNDANT) num_of_fault++;
+  }
+  part = (num_of_fault + num_of_threads - 1) / num_of_threads;
+  t = 0;
+  for (FSIM_CONTEXT& ctx: fsim_context) ctx.fault_list.clear();
+  for (fptr f: flist_undetect) {
+    if (f->detect == REDUNDANT) { continue; } /* ignore redundant faults */
+    if (fsim_context[t].fault_list.size() == part) t++;
+    fsim_context[t].fault_list.push_back(f);
+  }
+}/* end of partition_fault_list */
+
+/* fault simulate the faults of ctx, rail_words * 64 faults per packet.
+ * only the private rails and flags of ctx are written, and the detect
+ * field of its own faults */
+void ATPG::fault_sim_packets64(FSIM_CONTEXT& ctx) {
+  wptr faulty_wire;
+  /* array of fptrs, which points to the faults in a simulation packet  */
+  fptr simulated_fault_list[max_fault_slot];
+  int fault_type;
+  int i, k, start_wire_index, nckt;
+  int num_of_fault, num_of_slot;
+
+  num_of_fault = 0; // counts the number of faults in a packet
+  num_of_slot = rail_words * 64;
+
+  /* Keep track of the minimum wire index of the faults in a packet. */
+  start_wire_index = 10000;
+
+  /* start from the fault-free rails */
+  nckt = sort_wlist.size();
+  for (i = 0; i < nckt; i++) {
+    for (k = 0; k < rail_words; k++) {
+      ctx.faulty_one[i * rail_words + k] = good_one[i];
+      ctx.faulty_zero[i * rail_words + k] = good_zero[i];
+    }
+  }
+
+  /* walk through every fault of this context */
+  for (fptr f: ctx.fault_list) {
+
+    /* consider only active (aka. excited) fault
+     * (sa1 with correct output of 0 or sa0 with correct output of 1) */
+    if (f->fault_type != sort_wlist[f->to_swlist]->value) {
+
+      /* if f is a primary output or is directly connected to an primary output
+       * the fault is detected */
+      if ((f->node->type == OUTPUT) ||
+          (f->io == GO && sort_wlist[f->to_swlist]->flag & OUTPUT)) {
+        f->detect = TRUE;
+      }
+      else {
+
+        /* if f is an gate output fault, the faulty wire is the fault site.
+         * if f is a gate input fault and it is propagated, the faulty wire is
+         * the gate output of f.  see get_faulty_wire */
+        if (f->io == GO) {
+          faulty_wire = sort_wlist[f->to_swlist];
+          fault_type = f->fault_type;
+        }
+        else {
+          faulty_wire = get_faulty_wire(f, fault_type);
+          /* if the faulty_wire is a primary output, it is detected */
+          if ((faulty_wire != nullptr) && (faulty_wire->flag & OUTPUT)) {
+            f->detect = TRUE;
+            faulty_wire = nullptr;
+          }
+        }
+
+        if (faulty_wire != nullptr) {
+          /* if this wire is not yet marked as faulty, mark the wire as faulty
+           * and insert the corresponding wire to the list of faulty wires. */
+          if (!(ctx.flag[faulty_wire->wlist_index] & FAULTY)) {
+            ctx.flag[faulty_wire->wlist_index] |= FAULTY;
+            ctx.wlist_faulty.push_back(faulty_wire);
+          }
+
+          /* add the fault to the simulated fault list and inject the fault */
+          simulated_fault_list[num_of_fault] = f;
+          inject_fault_value64(ctx, faulty_wire, num_of_fault, fault_type);
+
+          /* mark the wire as having a fault injected
+           * and schedule the outputs of this gate */
+          ctx.flag[faulty_wire->wlist_index] |= FAULT_INJECTED;
+          for (i = fanout_start[faulty_wire->wlist_index]; i < fanout_start[faulty_wire->wlist_index + 1]; i++) {
+            ctx.flag[fanout_index[i]] |= SCHEDULED;
+          }
+
+          num_of_fault++;
+          start_wire_index = min(start_wire_index, f->to_swlist);
+        }
+      }
+    } // if fault is active
+
+    /* if this packet is full, do the fault simulation */
+    if (num_of_fault == num_of_slot) {
+      fault_sim_flush64(ctx, simulated_fault_list, num_of_fault, start_wire_index);
+      num_of_fault = 0;  // reset the counter of faults in a packet
+      start_wire_index = 10000;  //reset this index to a very large value.
+    }
+  } // end loop. for f = ctx.fault_list
+
+  /* simulate the last, partially filled packet */
+  if (num_of_fault > 0) {
+    fault_sim_flush64(ctx, simulated_fault_list, num_of_fault, start_wire_index);
+  }
+}/* end of fault_sim_packets64 */
+
+/* fault simulation of a packet */
+void ATPG::fault_sim_flush64(FSIM_CONTEXT& ctx, const fptr* simulated_fault_list,
+                             const int& num_of_fault, const int& start_wire_index) {
+  wptr w;
+  int i, k, nckt;
+  uint64_t detected;
+
+  /* starting with start_wire_index, evaulate all scheduled wires */
+  nckt = sort_wlist.size();
+  for (i = start_wire_index; i < nckt; i++) {
+    if (ctx.flag[i] & SCHEDULED) {
+      ctx.flag[i] &= ~SCHEDULED;
+      (this->*fault_sim_kernel)(ctx, i);
+    }
+  } /* event evaluations end here */
+
+  /* pop out all faulty wires from the wlist_faulty.
+   * a fault is detected on a PO if its faulty value and the good value
+   * are both known and different, i.e. one rail of the faulty value
+   * meets the opposite rail of the good value.
+   * reset the faulty rails back to the fault-free rails. */
+  while (!ctx.wlist_faulty.empty()) {
+    w = ctx.wlist_faulty.back();
+    ctx.wlist_faulty.pop_back();
+    i = w->wlist_index;
+    ctx.flag[i] &= ~(FAULTY | FAULT_INJECTED);
+    for (k = 0; k < rail_words; k++) {
+      ctx.inject_mask[i * rail_words + k] = ALL_ZERO64;
+      if (w->flag & OUTPUT) { // if primary output
+        detected = (ctx.faulty_one[i * rail_words + k] & good_zero[i]) |
+                   (ctx.faulty_zero[i * rail_words + k] & good_one[i]);
+        while (detected) {
+          simulated_fault_list[k * 64 + __builtin_ctzll(detected)]->detect = TRUE;
+          detected &= detected - 1;
+        }
+      }
+      ctx.faulty_one[i * rail_words + k] = good_one[i];  // reset to fault-free values
+      ctx.faulty_zero[i * rail_words + k] = good_zero[i];
+    }
+  } // pop out all faulty wires
+}/* end of fault_sim_flush64 */
+
+/* pick the gate evaluation kernel for the current rail width.
+ * 256-fault packets use AVX2 and 512-fault packets use AVX-512 when the
+ * running CPU supports them, otherwise the portable word loop is used. */
+void ATPG::select_fault_sim_kernel(void) {
+  fault_sim_kernel = &ATPG::fault_sim_evaluate64;
+#ifdef HAVE_X86_KERNELS
+  __builtin_cpu_init();
+  if ((rail_words == 4) && __builtin_cpu_supports("avx2")) {
+    fault_sim_kernel = &ATPG::fault_sim_evaluate_avx2;
+  }
+  if ((rail_words == 8) && __builtin_cpu_supports("avx512f")) {
+    fault_sim_kernel = &ATPG::fault_sim_evaluate_avx512;
+  }
+#endif
+}/* end of select_fault_sim_kernel */
+
+/* evaluate wire w_index, portable version for any rail width
+ * 1. update the faulty rails of w
+ * 2. schedule new events if the faulty rails differ from the good rails */
+void ATPG::fault_sim_evaluate64(FSIM_CONTEXT& ctx, const int& w_index) {
+  uint64_t new_one[max_rail_words], new_zero[max_rail_words];
+  const uint64_t *a_one, *a_zero, *b_one, *b_zero;
+  uint64_t diff;
+  int i, k, begin, end, idx;
+
+  begin = fanin_start[w_index];
+  end = fanin_start[w_index + 1];
+  switch(gate_type[w_index]) {
+    /* a 1-rail survives an AND only if it is set on every input,
+     * a 0-rail is produced by any input */
+    case AND:
+    case BUF:
+    case NAND:
+      for (k = 0; k < rail_words; k++) {
+        new_one[k] = ALL_ONE64;
+        new_zero[k] = ALL_ZERO64;
+      }
+      for (i = begin; i < end; i++) {
+        idx = fanin_index[i] * rail_words;
+        for (k = 0; k < rail_words; k++) {
+          new_one[k] &= ctx.faulty_one[idx + k];
+          new_zero[k] |= ctx.faulty_zero[idx + k];
+        }
+      }
+      if (gate_type[w_index] == NAND) {
+        for (k = 0; k < rail_words; k++) {
+          swap(new_one[k], new_zero[k]);  // inversion swaps the rails
+        }
+      }
+      break;
+
+    case OR:
+    case NOR:
+      for (k = 0; k < rail_words; k++) {
+        new_one[k] = ALL_ZERO64;
+        new_zero[k] = ALL_ONE64;
+      }
+      for (i = begin; i < end; i++) {
+        idx = fanin_index[i] * rail_words;
+        for (k = 0; k < rail_words; k++) {
+          new_one[k] |= ctx.faulty_one[idx + k];
+          new_zero[k] &= ctx.faulty_zero[idx + k];
+        }
+      }
+      if (gate_type[w_index] == NOR) {
+        for (k = 0; k < rail_words; k++) {
+          swap(new_one[k], new_zero[k]);
+        }
+      }
+      break;
+
+    case NOT:
+      idx = fanin_index[begin] * rail_words;
+      for (k = 0; k < rail_words; k++) {
+        new_one[k] = ctx.faulty_zero[idx + k];
+        new_zero[k] = ctx.faulty_one[idx + k];
+      }
+      break;
+
+    case XOR:
+    case EQV:
+      a_one = &ctx.faulty_one[fanin_index[begin] * rail_words];
+      a_zero = &ctx.faulty_zero[fanin_index[begin] * rail_words];
+      b_one = &ctx.faulty_one[fanin_index[begin + 1] * rail_words];
+      b_zero = &ctx.faulty_zero[fanin_index[begin + 1] * rail_words];
+      for (k = 0; k < rail_words; k++) {
+        new_one[k] = (a_one[k] & b_zero[k]) | (a_zero[k] & b_one[k]);
+        new_zero[k] = (a_one[k] & b_one[k]) | (a_zero[k] & b_zero[k]);
+      }
+      if (gate_type[w_index] == EQV) {
+        for (k = 0; k < rail_words; k++) {
+          swap(new_one[k], new_zero[k]);
+        }
+      }
+      break;
+  }
+
+  /* if the new value is different than the good value, save it */
+  diff = ALL_ZERO64;
+  for (k = 0; k < rail_words; k++) {
+    diff |= (new_one[k] ^ good_one[w_index]) | (new_zero[k] ^ good_zero[w_index]);
+  }
+  if (diff) {
+    idx = w_index * rail_words;
+
+    /* if this wire is faulty, make sure the fault remains injected */
+    if (ctx.flag[w_index] & FAULT_INJECTED) {
+      for (k = 0; k < rail_words; k++) {
+        new_one[k] = (new_one[k] & ~ctx.inject_mask[idx + k]) | (ctx.faulty_one[idx + k] & ctx.inject_mask[idx + k]);
+        new_zero[k] = (new_zero[k] & ~ctx.inject_mask[idx + k]) | (ctx.faulty_zero[idx + k] & ctx.inject_mask[idx + k]);
+      }
+    }
+
+    /* update the faulty rails */
+    for (k = 0; k < rail_words; k++) {
+      ctx.faulty_one[idx + k] = new_one[k];
+      ctx.faulty_zero[idx + k] = new_zero[k];
+    }
+    schedule_faulty_wire(ctx, w_index);
+  } // if new value is differnt
+}/* end of fault_sim_evaluate64 */
+
+#ifdef HAVE_X86_KERNELS
+/* evaluate wire w_index, 256 faults per packet, one __m256i per rail */
+__attribute__((target("avx2")))
+void ATPG::fault_sim_evaluate_avx2(FSIM_CONTEXT& ctx, const int& w_index) {
+  __m256i new_one, new_zero, a_one, a_zero, b_one, b_zero, tmp, mask, diff;
+  int i, begin, end;
+  uint64_t *rail_one, *rail_zero;
+
+  begin = fanin_start[w_index];
+  end = fanin_start[w_index + 1];
+  switch(gate_type[w_index]) {
+    case AND:
+    case BUF:
+    case NAND:
+      new_one = _mm256_set1_epi64x(-1);
+      new_zero = _mm256_setzero_si256();
+      for (i = begin; i < end; i++) {
+        new_one = _mm256_and_si256(new_one, _mm256_loadu_si256((const __m256i*)&ctx.faulty_one[fanin_index[i] * 4]));
+        new_zero = _mm256_or_si256(new_zero, _mm256_loadu_si256((const __m256i*)&ctx.faulty_zero[fanin_index[i] * 4]));
+      }
+      if (gate_type[w_index] == NAND) {
+        tmp = new_one; new_one = new_zero; new_zero = tmp;
+      }
+      break;
+
+    case OR:
+    case NOR:
+      new_one = _mm256_setzero_si256();
+      new_zero = _mm256_set1_epi64x(-1);
+      for (i = begin; i < end; i++) {
+        new_one = _mm256_or_si256(new_one, _mm256_loadu_si256((const __m256i*)&ctx.faulty_one[fanin_index[i] * 4]));
+        new_zero = _mm256_and_si256(new_zero, _mm256_loadu_si256((const __m256i*)&ctx.faulty_zero[fanin_index[i] * 4]));
+      }
+      if (gate_type[w_index] == NOR) {
+        tmp = new_one; new_one = new_zero; new_zero = tmp;
+      }
+      break;
+
+    case NOT:
+      new_one = _mm256_loadu_si256((const __m256i*)&ctx.faulty_zero[fanin_index[begin] * 4]);
+      new_zero = _mm256_loadu_si256((const __m256i*)&ctx.faulty_one[fanin_index[begin] * 4]);
+      break;
+
+    case XOR:
+    case EQV:
+      a_one = _mm256_loadu_si256((const __m256i*)&ctx.faulty_one[fanin_index[begin] * 4]);
+      a_zero = _mm256_loadu_si256((const __m256i*)&ctx.faulty_zero[fanin_index[begin] * 4]);
+      b_one = _mm256_loadu_si256((const __m256i*)&ctx.faulty_one[fanin_index[begin + 1] * 4]);
+      b_zero = _mm256_loadu_si256((const __m256i*)&ctx.faulty_zero[fanin_index[begin + 1] * 4]);
+      new_one = _mm256_or_si256(_mm256_and_si256(a_one, b_zero), _mm256_and_si256(a_zero, b_one));
+      new_zero = _mm256_or_si256(_mm256_and_si256(a_one, b_one), _mm256_and_si256(a_zero, b_zero));
+      if (gate_type[w_index] == EQV) {
+        tmp = new_one; new_one = new_zero; new_zero = tmp;
+      }
+      break;
+  }
+
+  /* if the new value is different than the good value, save it */
+  diff = _mm256_or_si256(_mm256_xor_si256(new_one, _mm256_set1_epi64x(good_one[w_index])),
+                         _mm256_xor_si256(new_zero, _mm256_set1_epi64x(good_zero[w_index])));
+  if (!_mm256_testz_si256(diff, diff)) {
+    rail_one = &ctx.faulty_one[w_index * 4];
+    rail_zero = &ctx.faulty_zero[w_index * 4];
+
+    /* if this wire is faulty, make sure the fault remains injected */
+    if (ctx.flag[w_index] & FAULT_INJECTED) {
+      mask = _mm256_loadu_si256((const __m256i*)&ctx.inject_mask[w_index * 4]);
+      new_one = _mm256_or_si256(_mm256_andnot_si256(mask, new_one),
+                                _mm256_and_si256(mask, _mm256_loadu_si256((const __m256i*)rail_one)));
+      new_zero = _mm256_or_si256(_mm256_andnot_si256(mask, new_zero),
+                                 _mm256_and_si256(mask, _mm256_loadu_si256((const __m256i*)rail_zero)));
+    }
+    _mm256_storeu_si256((__m256i*)rail_one, new_one);
+    _mm256_storeu_si256((__m256i*)rail_zero, new_zero);
+    schedule_faulty_wire(ctx, w_index);
+  }
+}/* end of fault_sim_evaluate_avx2 */
+
+/* evaluate wire w_index, 512 faults per packet, one __m512i per rail */
+__attribute__((target("avx512f")))
+void ATPG::fault_sim_evaluate_avx512(FSIM_CONTEXT& ctx, const int& w_index) {
+  __m512i new_one, new_zero, a_one, a_zero, b_one, b_zero, tmp, mask, diff;
+  int i, begin, end;
+  uint64_t *rail_one, *rail_zero;
+
+  begin = fanin_start[w_index];
+  end = fanin_start[w_index + 1];
+  switch(gate_type[w_index]) {
+    case AND:
+    case BUF:
+    case NAND:
+      new_one = _mm512_set1_epi64(-1);
+      new_zero = _mm512_setzero_si512();
+      for (i = begin; i < end; i++) {
+        new_one = _mm512_and_si512(new_one, _mm512_loadu_si512(&ctx.faulty_one[fanin_index[i] * 8]));
+        new_zero = _mm512_or_si512(new_zero, _mm512_loadu_si512(&ctx.faulty_zero[fanin_index[i] * 8]));
+      }
+      if (gate_type[w_index] == NAND) {
+        tmp = new_one; new_one = new_zero; new_zero = tmp;
+      }
+      break;
+
+    case OR:
+    case NOR:
+      new_one = _mm512_setzero_si512();
+      new_zero = _mm512_set1_epi64(-1);
+      for (i = begin; i < end; i++) {
+        new_one = _mm512_or_si512(new_one, _mm512_loadu_si512(&ctx.faulty_one[fanin_index[i] * 8]));
+        new_zero = _mm512_and_si512(new_zero, _mm512_loadu_si512(&ctx.faulty_zero[fanin_index[i] * 8]));
+      }
+      if (gate_type[w_index] == NOR) {
+        tmp = new_one; new_one = new_zero; new_zero = tmp;
+      }
+      break;
+
+    case NOT:
+      new_one = _mm512_loadu_si512(&ctx.faulty_zero[fanin_index[begin] * 8]);
+      new_zero = _mm512_loadu_si512(&ctx.faulty_one[fanin_index[begin] * 8]);
+      break;
+
+    case XOR:
+    case EQV:
+      a_one = _mm512_loadu_si512(&ctx.faulty_one[fanin_index[begin] * 8]);
+      a_zero = _mm512_loadu_si512(&ctx.faulty_zero[fanin_index[begin] * 8]);
+      b_one = _mm512_loadu_si512(&ctx.faulty_one[fanin_index[begin + 1] * 8]);
+      b_zero = _mm512_loadu_si512(&ctx.faulty_zero[fanin_index[begin + 1] * 8]);
+      new_one = _mm512_or_si512(_mm512_and_si512(a_one, b_zero), _mm512_and_si512(a_zero, b_one));
+      new_zero = _mm512_or_si512(_mm512_and_si512(a_one, b_one), _mm512_and_si512(a_zero, b_zero));
+      if (gate_type[w_index] == EQV) {
+        tmp = new_one; new_one = new_zero; new_zero = tmp;
+      }
+      break;
+  }
+
+  /* if the new value is different than the good value, save it */
+  diff = _mm512_or_si512(_mm512_xor_si512(new_one, _mm512_set1_epi64(good_one[w_index])),
+                         _mm512_xor_si512(new_zero, _mm512_set1_epi64(good_zero[w_index])));
+  if (_mm512_test_epi64_mask(diff, diff)) {
+    rail_one = &ctx.faulty_one[w_index * 8];
+    rail_zero = &ctx.faulty_zero[w_index * 8];
+
+    /* if this wire is faulty, make sure the fault remains injected */
+    if (ctx.flag[w_index] & FAULT_INJECTED) {
+      mask = _mm512_loadu_si512(&ctx.inject_mask[w_index * 8]);
+      new_one = _mm512_or_si512(_mm512_andnot_si512(mask, new_one),
+                                _mm512_and_si512(mask, _mm512_loadu_si512(rail_one)));
+      new_zero = _mm512_or_si512(_mm512_andnot_si512(mask, new_zero),
+                                 _mm512_and_si512(mask, _mm512_loadu_si512(rail_zero)));
+    }
+    _mm512_storeu_si512(rail_one, new_one);
+    _mm512_storeu_si512(rail_zero, new_zero);
+    schedule_faulty_wire(ctx, w_index);
+  }
+}/* end of fault_sim_evaluate_avx512 */
+#else
+/* no vector kernels on this target, select_fault_sim_kernel never picks these */
+void ATPG::fault_sim_evaluate_avx2(FSIM_CONTEXT& ctx, const int& w_index) { fault_sim_evaluate64(ctx, w_index); }
+void ATPG::fault_sim_evaluate_avx512(FSIM_CONTEXT& ctx, const int& w_index) { fault_sim_evaluate64(ctx, w_index); }
+#endif
+
+/* wire w_index now differs from the good machine:
+ * insert it into the faulty_wire list and schedule new events */
+void ATPG::schedule_faulty_wire(FSIM_CONTEXT& ctx, const int& w_index) {
+  int i;
+
+  if (!(ctx.flag[w_index] & FAULTY)) {
+    ctx.flag[w_index] |= FAULTY;
+    ctx.wlist_faulty.push_back(sort_wlist[w_index]);
+  }
+  for (i = fanout_start[w_index]; i < fanout_start[w_index + 1]; i++) {
+    ctx.flag[fanout_index[i]] |= SCHEDULED;
+  }
+}/* end of schedule_faulty_wire */
+
+/* This function injects a fault into slot bit_position of both rails */
+void ATPG::inject_fault_value64(FSIM_CONTEXT& ctx, const wptr faulty_wire, const int& bit_position, const int& fault_type) {
+  uint64_t slot = 1ULL << (bit_position & 63);
+  int idx = faulty_wire->wlist_index * rail_words + (bit_position >> 6);
+
+  if (fault_type == STUCK1) { // SA1 fault
+    ctx.faulty_one[idx] |= slot;
+    ctx.faulty_zero[idx] &= ~slot;
+  }
+  if (fault_type == STUCK0) { // SA0 fault
+    ctx.faulty_one[idx] &= ~slot;
+    ctx.faulty_zero[idx] |= slot;
+  }
+  ctx.inject_mask[idx] |= slot; // bit position of the fault
+}/* end of inject_fault_value64 */
@@ -0,0 +1,80 @@
+/**********************************************************************/
+/*           Worker threads of the parallel fault simulator           */
+/*                                                                    */
+/*           one job per test vector, one fault partition per thread  */
+/**********************************************************************/
+
+#include "atpg.h"
+
+/* The main thread posts a job (a member function taking a FSIM_CONTEXT)
+ * by bumping fsim_generation.  Worker t runs the job on fsim_context[t],
+ * the main thread runs it on fsim_context[0] and then waits until every
+ * worker is done.  The workers are started when the contexts are
+ * allocated and stay alive until stop_fsim_workers. */
+
+/* start num_of_threads - 1 workers, stopping the old ones first */
+void ATPG::start_fsim_workers(void) {
+  int t;
+
+  stop_fsim_workers();
+  fsim_quit = false;
+  for (t = 1; t < num_of_threads; t++) {
+    fsim_worker.push_back(thread(&ATPG::fsim_worker_loop, this, t, fsim_generation));
+  }
+}/* end of start_fsim_workers */
+
+/* ask the workers to exit and join them */
+void ATPG::stop_fsim_workers(void) {
+  {
+    lock_guard<mutex> lock(fsim_mutex);
+    fsim_quit = true;
+  }
+  fsim_start.notify_all();
+  for (thread& worker: fsim_worker) {
+    worker.join();
+  }
+  fsim_worker.clear();
+}/* end of stop_fsim_workers */
+
+/* run job on every context and return when all of them are done */
+void ATPG::run_fsim_job(void (ATPG::*job)(FSIM_CONTEXT&)) {
+  if (fsim_worker.empty()) {
+    (this->*job)(fsim_context[0]);
+    return;
+  }
+  {
+    lock_guard<mutex> lock(fsim_mutex);
+    fsim_job = job;
+    fsim_pending = fsim_worker.size();
+    fsim_generation++;
+  }
+  fsim_start.notify_all();
+
+  (this->*job)(fsim_context[0]);
+
+  unique_lock<mutex> lock(fsim_mutex);
+  fsim_done.wait(lock, [&]{ return (fsim_pending == 0); });
+}/* end of run_fsim_job */
+
+/* body of worker t, generation is the last job the worker has seen */
+void ATPG::fsim_worker_loop(const int t, int generation) {
+  void (ATPG::*job)(FSIM_CONTEXT&);
+
+  while (true) {
+    {
+      unique_lock<mutex> lock(fsim_mutex);
+      fsim_start.wait(lock, [&]{ return (fsim_quit || fsim_generation != generation); });
+      if (fsim_quit) return;
+      generation = fsim_generation;
+      job = fsim_job;
+    }
+
+    (this->*job)(fsim_context[t]);
+
+    {
+      lock_guard<mutex> lock(fsim_mutex);
+      fsim_pending--;
+    }
+    fsim_done.notify_one();
+  }
+}/* end of fsim_worker_loop */
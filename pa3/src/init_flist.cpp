@@ -15,7 +15,7 @@ void ATPG::generate_fault_list(void) {
   int fault_num;
   wptr w;
   nptr n;
-  fptr_s f;
+  fptr f;
   
   /* walk through every wire in the circuit*/
   for (auto pos = sort_wlist.crbegin(); pos != sort_wlist.crend(); ++pos) {
@@ -23,35 +23,32 @@ void ATPG::generate_fault_list(void) {
     n = w->inode.front();
     
     /* for each gate, create a gate output slow-to-rise (STR) fault */
-    f = move(fptr_s(new(nothrow) FAULT));
-    if (f == nullptr) error("No more room!");
+    f = fault_pool.create();
     f->node = n;
     f->io = GO;
     f->fault_type = STR;
     f->to_swlist = w->wlist_index;
     f->eqv_fault_num = 1;
     num_of_gate_fault += f->eqv_fault_num; // accumulate total fault count
-    flist_undetect.push_front(f.get()); // initial undetected fault list contains all faults
-    flist.push_front(move(f));  // push into the fault list
+    flist_undetect.push_front(f); // initial undetected fault list contains all faults
+    flist.push_front(f);  // push into the fault list
     
     /* for each gate, create a gate output slow-to-fall (STF) fault */
-    f = move(fptr_s(new(nothrow) FAULT));
-    if (f == nullptr) error("No more room!");
+    f = fault_pool.create();
     f->node = n;
     f->io = GO;
     f->fault_type = STF;
     f->to_swlist = w->wlist_index;
     f->eqv_fault_num = 1;
     num_of_gate_fault += f->eqv_fault_num;
-    flist_undetect.push_front(f.get());
-    flist.push_front(move(f));
+    flist_undetect.push_front(f);
+    flist.push_front(f);
 
     /*if w has multiple fanout branches */
     if (w->onode.size() > 1) {
       for (nptr nptr_ele: w->onode) {
         /* create STR for gate inputs  */
-        f = move(fptr_s(new(nothrow) FAULT));
-        if (f == nullptr) error("No more room!");
+        f = fault_pool.create();
         f->node = nptr_ele;
         f->io = GI;
         f->fault_type = STR;
@@ -63,11 +60,10 @@ void ATPG::generate_fault_list(void) {
           if (nptr_ele->iwire[k] == w) f->index = k;
         }
         num_of_gate_fault++;
-        flist_undetect.push_front(f.get());
-        flist.push_front(move(f));
+        flist_undetect.push_front(f);
+        flist.push_front(f);
         /* create STF for gate inputs  */
-        f = move(fptr_s(new(nothrow) FAULT));
-        if (f == nullptr) error("No more room!");
+        f = fault_pool.create();
         f->node = nptr_ele;
         f->io = GI;
         f->fault_type = STF;
@@ -77,8 +73,8 @@ void ATPG::generate_fault_list(void) {
           if (nptr_ele->iwire[k] == w) f->index = k;
         }
         num_of_gate_fault++;
-        flist_undetect.push_front(f.get());
-        flist.push_front(move(f));
+        flist_undetect.push_front(f);
+        flist.push_front(f);
       }
     }
   }
@@ -108,7 +104,7 @@ void ATPG::compute_fault_coverage(void) {
   eqv_num_of_gate_fault = 0;
   
   for (auto pos = flist.cbegin(); pos != flist.cend(); ++pos) {
-    f = (*pos).get();
+    f = *pos;
     if (debug) {
       if (f->detect != 0) {
         switch (f->node->type) {
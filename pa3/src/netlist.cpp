@@ -0,0 +1,131 @@
+/**********************************************************************/
+/*           Compiled netlist for the simulation engines              */
+/*                                                                    */
+/*           flat arrays in level order, indexed by wlist_index       */
+/**********************************************************************/
+
+#include "atpg.h"
+
+/* Every wire and node is constructed in wire_pool/node_pool in the order of
+ * the circuit file, but the engines visit the wires in level order.  Once the
+ * structure is final (after create_dummy_gate), the objects are moved into one
+ * chunk per pool: the wires in sort_wlist order, each node next to the wire it
+ * drives, and whatever is left (the dummy PO gates) at the end.  The old
+ * pools are released in one go.  This must run before generate_fault_list,
+ * since the faults point to the nodes. */
+void ATPG::pack_circuit(void) {
+  POOL<WIRE> new_wire_pool;
+  POOL<NODE> new_node_pool;
+  vector<wptr> new_wlist;
+  vector<nptr> new_nlist;
+  unordered_map<wptr, wptr> new_wire;
+  unordered_map<nptr, nptr> new_node;
+  int i;
+
+  new_wire.reserve(wlist.size());
+  new_node.reserve(nlist.size());
+
+  /* the wires in level order, followed by any wire that is not levelled */
+  for (wptr w: sort_wlist) new_wire[w] = nullptr;
+  new_wire_pool.reserve(wlist.size());
+  for (wptr w: sort_wlist) new_wlist.push_back(w);
+  for (wptr w: wlist) {
+    if (new_wire.find(w) == new_wire.end()) new_wlist.push_back(w);
+  }
+  for (i = 0; i < new_wlist.size(); i++) {
+    wptr w = new_wire_pool.create();
+    *w = move(*new_wlist[i]);
+    new_wire[new_wlist[i]] = w;
+    new_wlist[i] = w;
+  }
+
+  /* the node driving each wire, then the others in the order of creation */
+  new_node_pool.reserve(nlist.size());
+  for (wptr w: new_wlist) {
+    for (nptr n: w->inode) {
+      if (new_node.find(n) != new_node.end()) continue;
+      new_node[n] = new_node_pool.create();
+      new_nlist.push_back(n);
+    }
+  }
+  for (nptr n: nlist) {
+    if (new_node.find(n) != new_node.end()) continue;
+    new_node[n] = new_node_pool.create();
+    new_nlist.push_back(n);
+  }
+  for (i = 0; i < new_nlist.size(); i++) {
+    nptr n = new_node[new_nlist[i]];
+    *n = move(*new_nlist[i]);
+    new_nlist[i] = n;
+  }
+
+  /* redirect every reference to the moved objects */
+  for (wptr w: new_wlist) {
+    for (nptr& n: w->inode) n = new_node[n];
+    for (nptr& n: w->onode) n = new_node[n];
+  }
+  for (nptr n: new_nlist) {
+    for (wptr& w: n->iwire) w = new_wire[w];
+    for (wptr& w: n->owire) w = new_wire[w];
+  }
+  for (wptr& w: sort_wlist) w = new_wire[w];
+  for (wptr& w: cktin) w = new_wire[w];
+  for (wptr& w: cktout) w = new_wire[w];
+
+  /* release the old objects and index the names again */
+  wire_pool.swap(new_wire_pool);
+  node_pool.swap(new_node_pool);
+  wlist.swap(new_wlist);
+  nlist.swap(new_nlist);
+  wire_table = NAME_TABLE();
+  node_table = NAME_TABLE();
+  for (i = 0; i < wlist.size(); i++) wire_table.insert(wlist[i]->name, i);
+  for (i = 0; i < nlist.size(); i++) node_table.insert(nlist[i]->name, i);
+}/* end of pack_circuit */
+
+/* The WIRE and NODE objects are scattered over the heap, and reaching the
+ * gate inputs of wire i through sort_wlist[i]->inode.front()->iwire[j]
+ * costs several dependent loads per input.  The engines evaluate gates on
+ * the flat copy below instead:
+ *   gate_type[i]  type of the gate driving wire i (INPUT for a PI)
+ *   fanin_index[fanin_start[i] .. fanin_start[i+1])
+ *                 wlist_index of the gate inputs of wire i, in iwire order
+ *   fanout_index[fanout_start[i] .. fanout_start[i+1])
+ *                 wlist_index of the gate outputs fed by wire i, in onode
+ *                 order.  the dummy PO gates are left out.
+ * The circuit structure never changes after create_dummy_gate, so the
+ * netlist is compiled once, right after it. */
+void ATPG::compile_netlist(void) {
+  int i, nckt;
+  wptr w;
+
+  nckt = sort_wlist.size();
+  gate_type.assign(nckt, INPUT);
+  fanin_start.assign(nckt + 1, 0);
+  fanout_start.assign(nckt + 1, 0);
+  fanin_index.clear();
+  fanout_index.clear();
+
+  for (i = 0; i < nckt; i++) {
+    w = sort_wlist[i];
+    if (!(w->flag & INPUT)) {
+      gate_type[i] = w->inode.front()->type;
+      for (wptr wptr_ele: w->inode.front()->iwire) {
+        fanin_index.push_back(wptr_ele->wlist_index);
+      }
+    }
+    fanin_start[i + 1] = fanin_index.size();
+
+    for (nptr nptr_ele: w->onode) {
+      if (nptr_ele->type != OUTPUT) {
+        fanout_index.push_back(nptr_ele->owire.front()->wlist_index);
+      }
+    }
+    fanout_start[i + 1] = fanout_index.size();
+  }
+
+  /* per-wire words of the 16-fault parallel fault simulator */
+  wire_value1.assign(nckt, ALL_ZERO);
+  wire_value2.assign(nckt, ALL_ZERO);
+  fault_flag.assign(nckt, ALL_ZERO);
+}/* end of compile_netlist */
@@ -0,0 +1,138 @@
+/**********************************************************************/
+/*           Bit-packed test pattern store                            */
+/*                                                                    */
+/*           two bits per primary input, see PATTERN_STORE in atpg.h  */
+/**********************************************************************/
+
+#include "atpg.h"
+
+/* Binary pattern file: a PATTERN_HEADER followed by
+ *   num_of_pattern * num_of_word  uint64_t   the packed patterns, as in bits
+ *   num_of_pattern                int        the targeted faults (PATTERN_TARGET)
+ * The file is written in the byte order of the host, like the circuit cache.
+ * read_vectors tells it from a text pattern file by the magic number. */
+
+#define PATTERN_MAGIC   "ATPGPAT\0"
+#define PATTERN_VERSION 1
+#define PATTERN_TARGET  0x1        /* flag: the targeted faults follow the patterns */
+
+struct PATTERN_HEADER {
+  char magic[8];
+  int version;
+  int flag;
+  int num_of_input;
+  int num_of_word;             /* words per pattern */
+  int num_of_pattern;
+  int reserved;
+};
+
+/* every input of a new pattern is unknown: 32 copies of the code 10 (U) */
+#define ALL_UNKNOWN64 0xaaaaaaaaaaaaaaaaULL
+
+/* empty the store and prepare it for patterns of n inputs */
+void ATPG::PATTERN_STORE::reset(const int& n) {
+  num_of_input = n;
+  num_of_word = (n + 31) >> 5;
+  num_of_pattern = 0;
+  bits.clear();
+  target.clear();
+}/* end of reset */
+
+/* append a pattern with every input unknown and return its index */
+int ATPG::PATTERN_STORE::add(void) {
+  bits.insert(bits.end(), num_of_word, ALL_UNKNOWN64);
+  target.push_back(-1);
+  return(num_of_pattern++);
+}/* end of add */
+
+/* append the pattern of one T'...' line of a pattern file.
+ * 'T', quotes and white space are skipped; any character other than
+ * 0 and 1 is an unknown.  inputs beyond the end of the line stay unknown
+ * and characters beyond the last input are ignored.
+ * return the number of inputs given by the line */
+int ATPG::PATTERN_STORE::add(const char *begin, const char *end) {
+  const char *c;
+  uint64_t word;
+  int i;
+  size_t w;
+
+  w = bits.size();
+  bits.insert(bits.end(), num_of_word, ALL_UNKNOWN64);
+  target.push_back(-1);
+  num_of_pattern++;
+
+  /* fill one word at a time, 32 inputs per word */
+  word = ALL_UNKNOWN64;
+  i = 0;
+  for (c = begin; (c < end) && (i < num_of_input); c++) {
+    if ((*c == 'T') || (*c == '\'') || (*c <= ' ')) continue;
+    if ((*c == '0') || (*c == '1')) {
+      word ^= (uint64_t) (*c - '0' + 2) << ((i & 31) << 1); // 10 -> 00 or 01
+    }
+    if ((++i & 31) == 0) {
+      bits[w++] = word;
+      word = ALL_UNKNOWN64;
+    }
+  }
+  if (i & 31) bits[w] = word;
+  return(i);
+}/* end of add */
+
+/* replace the store by the patterns of a binary pattern file.
+ * return false, and leave the store alone, if file is not one */
+bool ATPG::PATTERN_STORE::read(const string& file) {
+  PATTERN_HEADER h;
+  FILE *in;
+  bool ok;
+
+  in = fopen(file.c_str(), "rb");
+  if (in == nullptr) return false;
+  if ((fread(&h, sizeof(h), 1, in) != 1) || (memcmp(h.magic, PATTERN_MAGIC, sizeof(h.magic)) != 0)) {
+    fclose(in);
+    return false;
+  }
+  if ((h.version != PATTERN_VERSION) || (h.num_of_input < 0) || (h.num_of_pattern < 0) ||
+      (h.num_of_word != ((h.num_of_input + 31) >> 5))) {
+    fprintf(stderr,"File %s is not a supported binary pattern file\n",file.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  /* the patterns are loaded with a single read */
+  reset(h.num_of_input);
+  num_of_pattern = h.num_of_pattern;
+  bits.resize((size_t) num_of_pattern * num_of_word);
+  target.assign(num_of_pattern, -1);
+  ok = bits.empty() || (fread(bits.data(), sizeof(uint64_t), bits.size(), in) == bits.size());
+  if (ok && (h.flag & PATTERN_TARGET) && !target.empty()) {
+    ok = (fread(target.data(), sizeof(int), target.size(), in) == target.size());
+  }
+  fclose(in);
+  if (!ok) {
+    fprintf(stderr,"File %s is truncated\n",file.c_str());
+    exit(EXIT_FAILURE);
+  }
+  return true;
+}/* end of read */
+
+/* write the store to a binary pattern file.  return false on failure */
+bool ATPG::PATTERN_STORE::write(const string& file) const {
+  PATTERN_HEADER h;
+  FILE *out;
+  bool ok;
+
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, PATTERN_MAGIC, sizeof(h.magic));
+  h.version = PATTERN_VERSION;
+  h.flag = PATTERN_TARGET;
+  h.num_of_input = num_of_input;
+  h.num_of_word = num_of_word;
+  h.num_of_pattern = num_of_pattern;
+
+  out = fopen(file.c_str(), "wb");
+  if (out == nullptr) return false;
+  ok = (fwrite(&h, sizeof(h), 1, out) == 1);
+  ok = ok && (bits.empty() || fwrite(bits.data(), sizeof(uint64_t), bits.size(), out) == bits.size());
+  ok = ok && (target.empty() || fwrite(target.data(), sizeof(int), target.size(), out) == target.size());
+  ok = (fclose(out) == 0) && ok;
+  return ok;
+}/* end of write */
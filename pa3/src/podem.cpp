@@ -187,7 +187,7 @@ ATPG::wptr ATPG::fault_evaluate(const fptr fault) {
       if (fault->fault_type == STUCK0 && w->value == 1) w->value = D;
       if (fault->fault_type == STUCK1 && w->value == 0) w->value = B;
       if (fault->node->type == OUTPUT) return(nullptr);
-      evaluate(fault->node);  // five-valued, evaluate one gate only, sim.c
+      evaluate(fault->node->owire.front()->wlist_index);  // five-valued, evaluate one gate only, sim.c
       w->value = temp1;
 	  /* if GUT gate output changed */
       if (fault->node->owire.front()->flag & CHANGED) {
@@ -203,15 +203,14 @@ ATPG::wptr ATPG::fault_evaluate(const fptr fault) {
 /* iteratively foward implication
  * in a depth first search manner*/ 
 void ATPG::forward_imply(const wptr w) {
-  int i,nout;
-
-  for (i = 0, nout = w->onode.size(); i < nout; i++) {
-    if (w->onode[i]->type != OUTPUT) {
-      evaluate(w->onode[i]);
-      if (w->onode[i]->owire.front()->flag & CHANGED)
-	    forward_imply(w->onode[i]->owire.front()); // go one level further
-      w->onode[i]->owire.front()->flag &= ~CHANGED;
-    }
+  int i, j;
+
+  for (i = fanout_start[w->wlist_index]; i < fanout_start[w->wlist_index + 1]; i++) {
+    j = fanout_index[i];
+    evaluate(j);
+    if (sort_wlist[j]->flag & CHANGED)
+      forward_imply(sort_wlist[j]); // go one level further
+    sort_wlist[j]->flag &= ~CHANGED;
   }
 }/* end of forward_imply */
 
@@ -23,7 +23,7 @@
 */
 
 void ATPG::sim(void) {
-  int i, j, ncktin, nout, nckt;
+  int i, j, ncktin, nckt;
 
   ncktin = cktin.size();
   nckt = sort_wlist.size();
@@ -34,10 +34,8 @@ void ATPG::sim(void) {
     /* if a input has changed, schedule the gates connected to it */
     if (sort_wlist[i]->flag & CHANGED) {
       sort_wlist[i]->flag &= ~CHANGED;
-      for (j = 0, nout = sort_wlist[i]->onode.size(); j < nout; j++) {
-        if (!sort_wlist[i]->onode[j]->owire.empty()) {
-          sort_wlist[i]->onode[j]->owire.front()->flag |= SCHEDULED;
-        }
+      for (j = fanout_start[i]; j < fanout_start[i + 1]; j++) {
+        sort_wlist[fanout_index[j]]->flag |= SCHEDULED;
       }
     }
   } // for every input
@@ -51,13 +49,11 @@ void ATPG::sim(void) {
   for (i = ncktin; i < nckt; i++) {
     if (sort_wlist[i]->flag & SCHEDULED) {
       sort_wlist[i]->flag &= ~SCHEDULED;
-      evaluate(sort_wlist[i]->inode.front());
+      evaluate(i);
       if (sort_wlist[i]->flag & CHANGED) {
         sort_wlist[i]->flag &= ~CHANGED;
-        for (j = 0, nout = sort_wlist[i]->onode.size(); j < nout; j++) {
-          if (!sort_wlist[i]->onode[j]->owire.empty()) {
-            sort_wlist[i]->onode[j]->owire.front()->flag |= SCHEDULED;
-          }
+        for (j = fanout_start[i]; j < fanout_start[i + 1]; j++) {
+          sort_wlist[fanout_index[j]]->flag |= SCHEDULED;
         }
       }
     }
@@ -65,51 +61,56 @@ void ATPG::sim(void) {
   /*TODO*/
 }/* end of sim */
 
-void ATPG::evaluate(nptr n) {
+/* evaluate the gate driving wire w_index, see compile_netlist.
+ * the inputs are encoded (see logic_tbl.h) and combined with bitwise
+ * operations; a multiple-input gate is a chain of two-input steps */
+void ATPG::evaluate(const int& w_index) {
     int old_value, new_value;
-    int i, nin;
+    int i, begin, end;
+    unsigned int code;
 
-    old_value = n->owire.front()->value;
+    old_value = sort_wlist[w_index]->value;
 
-    /* decompose a multiple-input gate into multiple levels of two-input gates  
-     * then look up the truth table of each two-input gate
-     */
-    nin = n->iwire.size();
-    switch(n->type) {
+    begin = fanin_start[w_index];
+    end = fanin_start[w_index + 1];
+    switch(gate_type[w_index]) {
         case AND:
         case BUF:
         case NAND:
-            new_value = 1;
-            for (i = 0; i < nin; i++) {
-                new_value = ANDTABLE[n->iwire[i]->value][new_value];
+            code = L5_ENCODE(1);
+            for (i = begin; i < end; i++) {
+                code = l5_and(code, L5_ENCODE(sort_wlist[fanin_index[i]]->value));
             }
-            if (n->type == NAND) {
-                new_value = INV[new_value];
+            if (gate_type[w_index] == NAND) {
+                code = l5_inv(code);
             }
             break;
         case OR:
         case NOR:
-            new_value = 0;
-            for (i = 0; i < nin; i++) {
-                new_value = ORTABLE[n->iwire[i]->value][new_value];
+            code = L5_ENCODE(0);
+            for (i = begin; i < end; i++) {
+                code = l5_or(code, L5_ENCODE(sort_wlist[fanin_index[i]]->value));
             }
-            if (n->type == NOR) {
-                new_value = INV[new_value];
+            if (gate_type[w_index] == NOR) {
+                code = l5_inv(code);
             }
             break;
         case NOT:
-            new_value = INV[n->iwire.front()->value];
+            code = l5_inv(L5_ENCODE(sort_wlist[fanin_index[begin]]->value));
             break;
         case XOR:
-            new_value = XORTABLE[n->iwire[0]->value][n->iwire[1]->value];
-            break;
         case EQV:
-            new_value =INV[(XORTABLE[n->iwire[0]->value][n->iwire[1]->value])];
+            code = l5_xor(L5_ENCODE(sort_wlist[fanin_index[begin]]->value),
+                          L5_ENCODE(sort_wlist[fanin_index[begin + 1]]->value));
+            if (gate_type[w_index] == EQV) {
+                code = l5_inv(code);
+            }
             break;
     }
+    new_value = L5_DECODE(code);
     if (old_value != new_value) {
-        n->owire.front()->flag |= CHANGED;
-        n->owire.front()->value = new_value;
+        sort_wlist[w_index]->flag |= CHANGED;
+        sort_wlist[w_index]->value = new_value;
     }
     return;
 }/* end of evaluate */
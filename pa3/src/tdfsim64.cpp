@@ -0,0 +1,192 @@
+/**********************************************************************/
+/*  Dual-Rail Parallel-Fault Transition Delay Fault Simulator         */
+/*                                                                    */
+/*  64, 256 or 512 faults per packet; gate evaluation kernels are     */
+/*  shared with the stuck-at engine, see faultsim64.cpp               */
+/**********************************************************************/
+
+#include "atpg.h"
+
+/* at most 512 faults (eight 64-bit words per rail) in one packet */
+#define max_fault_slot 512
+
+/* transition delay fault simulate a single test vector, packet_size faults per packet */
+void ATPG::tdfsim_a_vector64(const int& p, int& num_of_current_detect) {
+  int i, nckt;
+
+  /* num_of_current_detect is used to keep track of the number of undetected
+   * faults detected by this vector, initialize it to zero */
+  num_of_current_detect = 0;
+
+  /*************************
+   * V1 simulation
+   *************************/
+  for(i = 0; i < cktin.size(); i++) {
+    cktin[i]->value = patterns.get(p, i);
+  }
+  nckt = sort_wlist.size();
+  for (i = 0; i < nckt; i++) {
+    sort_wlist[i]->flag &= ~CHANGED;
+    if (i < cktin.size()) {
+      sort_wlist[i]->flag |= CHANGED;
+    }
+    else {
+      sort_wlist[i]->value = U;
+    }
+  }
+  sim(); /* do a fault-free simulation, see sim.c */
+  if (debug) { display_io(); }
+
+  for (i = 0; i < nckt; i++) {
+    sort_wlist[i]->value_v1 = sort_wlist[i]->value;
+  } // for i
+
+  /*************************
+   * V2 simulation
+   *************************/
+  /* V2 is V1 shifted by one position (launch-on-shift) */
+  for(i = 0; i < cktin.size(); i++) {
+    cktin[i]->value = patterns.get(p, (i == 0) ? cktin.size() : i - 1);
+  }
+  for (i = 0; i < nckt; i++) {
+    sort_wlist[i]->flag &= ~CHANGED;
+    if (i < cktin.size()) {
+      sort_wlist[i]->flag |= CHANGED;
+    }
+    else {
+      sort_wlist[i]->value = U;
+    }
+  }
+  sim(); /* do a fault-free simulation, see sim.c */
+  if (debug) { display_io(); }
+
+  setup_fault_sim64();
+  partition_fault_list();
+  run_fsim_job(&ATPG::tdf_fault_sim_packets64);
+
+  /* fault dropping  */
+  flist_undetect.remove_if(
+    [&](const fptr fptr_ele){
+      if (fptr_ele->detect == TRUE) {
+        num_of_current_detect += fptr_ele->eqv_fault_num;
+        return true;
+      }
+      else {
+        return false;
+      }
+    });
+}/* end of tdfsim_a_vector64 */
+
+/* transition delay fault simulate the faults of ctx on the V2 rails,
+ * rail_words * 64 faults per packet, see fault_sim_packets64 */
+void ATPG::tdf_fault_sim_packets64(FSIM_CONTEXT& ctx) {
+  wptr faulty_wire;
+  /* array of fptrs, which points to the faults in a simulation packet  */
+  fptr simulated_fault_list[max_fault_slot];
+  int fault_type;
+  int i, k, start_wire_index, nckt;
+  int num_of_fault, num_of_slot;
+  bool fault_active;
+
+  num_of_fault = 0; // counts the number of faults in a packet
+  num_of_slot = rail_words * 64;
+
+  /* Keep track of the minimum wire index of the faults in a packet. */
+  start_wire_index = 10000;
+
+  /* start from the fault-free V2 rails */
+  nckt = sort_wlist.size();
+  for (i = 0; i < nckt; i++) {
+    for (k = 0; k < rail_words; k++) {
+      ctx.faulty_one[i * rail_words + k] = good_one[i];
+      ctx.faulty_zero[i * rail_words + k] = good_zero[i];
+    }
+  }
+
+  /* walk through every fault of this context */
+  for (fptr f: ctx.fault_list) {
+
+    /* consider only active (aka. excited) fault
+     * (STR(0) with correct output of 0 or STF(1) with correct output of 1) */
+    fault_active = false;
+    switch (f->fault_type) {
+      case STR: fault_active = (sort_wlist[f->to_swlist]->value_v1 == 0 &&
+                                sort_wlist[f->to_swlist]->value == 1);
+                break;
+      case STF: fault_active = (sort_wlist[f->to_swlist]->value_v1 == 1 &&
+                                sort_wlist[f->to_swlist]->value == 0);
+                break;
+    }
+
+    if (fault_active) {
+      /* if f is a primary output or is directly connected to an primary output
+       * the fault is detected */
+      if ((f->node->type == OUTPUT) ||
+          (f->io == GO && sort_wlist[f->to_swlist]->flag & OUTPUT)) {
+        f->detect = TRUE;
+      }
+      else {
+        if (f->io == GO) {
+          faulty_wire = sort_wlist[f->to_swlist];
+          fault_type = f->fault_type;
+        }
+        else {
+          faulty_wire = tdf_get_faulty_wire(f, fault_type);
+          /* if the faulty_wire is a primary output, it is detected */
+          if ((faulty_wire != nullptr) && (faulty_wire->flag & OUTPUT)) {
+            f->detect = TRUE;
+            faulty_wire = nullptr;
+          }
+        }
+
+        if (faulty_wire != nullptr) {
+          if (!(ctx.flag[faulty_wire->wlist_index] & FAULTY)) {
+            ctx.flag[faulty_wire->wlist_index] |= FAULTY;
+            ctx.wlist_faulty.push_back(faulty_wire);
+          }
+
+          /* add the fault to the simulated fault list and inject the fault */
+          simulated_fault_list[num_of_fault] = f;
+          tdf_inject_fault_value64(ctx, faulty_wire, num_of_fault, fault_type);
+
+          ctx.flag[faulty_wire->wlist_index] |= FAULT_INJECTED;
+          for (i = fanout_start[faulty_wire->wlist_index]; i < fanout_start[faulty_wire->wlist_index + 1]; i++) {
+            ctx.flag[fanout_index[i]] |= SCHEDULED;
+          }
+
+          num_of_fault++;
+          start_wire_index = min(start_wire_index, f->to_swlist);
+        }
+      }
+    } // if fault is active
+
+    /* if this packet is full, do the fault simulation */
+    if (num_of_fault == num_of_slot) {
+      fault_sim_flush64(ctx, simulated_fault_list, num_of_fault, start_wire_index);
+      num_of_fault = 0;  // reset the counter of faults in a packet
+      start_wire_index = 10000;  //reset this index to a very large value.
+    }
+  } // end loop. for f = ctx.fault_list
+
+  /* simulate the last, partially filled packet */
+  if (num_of_fault > 0) {
+    fault_sim_flush64(ctx, simulated_fault_list, num_of_fault, start_wire_index);
+  }
+}/* end of tdf_fault_sim_packets64 */
+
+/* This function injects a transition fault into slot bit_position of both rails.
+ * a slow-to-fall wire is held at 1, a slow-to-rise wire is held at 0 */
+void ATPG::tdf_inject_fault_value64(FSIM_CONTEXT& ctx, const wptr faulty_wire, const int& bit_position, const int& fault_type) {
+  uint64_t slot = 1ULL << (bit_position & 63);
+  int idx = faulty_wire->wlist_index * rail_words + (bit_position >> 6);
+
+  if (fault_type == STF) {
+    ctx.faulty_one[idx] |= slot;
+    ctx.faulty_zero[idx] &= ~slot;
+  }
+  if (fault_type == STR) {
+    ctx.faulty_one[idx] &= ~slot;
+    ctx.faulty_zero[idx] |= slot;
+  }
+  ctx.inject_mask[idx] |= slot; // bit position of the fault
+}/* end of tdf_inject_fault_value64 */
@@ -1,7 +1,7 @@
 #include "atpg.h"
 
 void ATPG::test(void) {
-  string vec;
+  int i, p;
   int current_detect_num = 0;
   int total_detect_num = 0;
   int total_no_of_backtracks = 0;  // accumulative number of backtracks
@@ -16,7 +16,8 @@ void ATPG::test(void) {
   if(fsim_only)
   {
     fault_simulate_vectors(total_detect_num);
-    in_vector_no+=vectors.size();
+    in_vector_no+=patterns.size();
+    stop_fsim_workers();
     display_undetect();
     fprintf(stdout,"\n");
     return;
@@ -25,25 +26,33 @@ void ATPG::test(void) {
   if(tdfsim_only)
   {
     transition_delay_fault_simulation();
-    
+    stop_fsim_workers();
     return;
   }// if tdfsim only
 
 
   /* ATPG mode */
+  /* the generated vectors are kept in the pattern store */
+  patterns.reset(cktin.size());
+
   /* Figure 5 in the PODEM paper */
   while(fault_under_test != nullptr) {
     switch(podem(fault_under_test,current_backtracks)) {
       case TRUE:
         /* form a vector */
-        vec.clear();
-        for (wptr w: cktin) {
-          vec.push_back(itoc(w->value));
+        p = patterns.add();
+        patterns.set_target(p, fault_under_test->fault_no);
+        for (i = 0; i < cktin.size(); i++) {
+          switch (cktin[i]->value) {
+            case D: patterns.set(p, i, 1); break;
+            case B: patterns.set(p, i, 0); break;
+            default: patterns.set(p, i, cktin[i]->value); break;
+          }
         }
         /*by defect, we want only one pattern per fault */
         /*run a fault simulation, drop ALL detected faults */
         if (total_attempt_num == 1) {
-          fault_sim_a_vector(vec, current_detect_num);
+          fault_sim_a_vector(p, current_detect_num);
           total_detect_num += current_detect_num;
         }
         /* If we want mutiple petterns per fault, 
@@ -76,6 +85,10 @@ void ATPG::test(void) {
     no_of_calls++;
   }
 
+  stop_fsim_workers();
+  if (!pattern_file.empty() && !patterns.write(pattern_file)) {
+    fprintf(stderr,"File %s could not be written\n",pattern_file.c_str());
+  }
   display_undetect();
   fprintf(stdout,"\n");
   fprintf(stdout,"#number of aborted faults = %d\n",no_of_aborted_faults);
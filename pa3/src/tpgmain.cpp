@@ -38,6 +38,31 @@ main(int argc, char *argv[]) {
       atpg.set_tdfsim_only(true);
       i+=2;
     }
+    else if (strcmp(argv[i],"-threads") == 0) {
+      if (atoi(argv[i+1]) < 1) {
+        fprintf(stderr, "atpg: number of threads should >= 1\n");
+        usage();
+      }
+      atpg.set_num_of_threads(atoi(argv[i+1]));
+      i+=2;
+    }
+    else if (strcmp(argv[i],"-nocache") == 0) {
+      atpg.set_circuit_cache(false);
+      i++;
+    }
+    else if (strcmp(argv[i],"-bpat") == 0) {
+      atpg.set_pattern_file(string(argv[i+1]));
+      i+=2;
+    }
+    else if (strcmp(argv[i],"-packet") == 0) {
+      if ((atoi(argv[i+1]) != 16) && (atoi(argv[i+1]) != 64) &&
+          (atoi(argv[i+1]) != 256) && (atoi(argv[i+1]) != 512)) {
+        fprintf(stderr, "atpg: packet size should be 16, 64, 256 or 512\n");
+        usage();
+      }
+      atpg.set_packet_size(atoi(argv[i+1]));
+      i+=2;
+    }
     else if (argv[i][0] == '-') {
       j = 1;
       while (argv[i][j] != '\0') {
@@ -60,24 +85,42 @@ main(int argc, char *argv[]) {
 /* an input file was not specified, so describe the proper usage */
   if (inpFile.empty()) { usage(); }
 
+/* map the cached circuit and fault list, if the cache is up to date */
+  if (atpg.load_circuit_cache(inpFile)) { // cache.cpp
+    atpg.timer(stdout,"for loading circuit cache");
+  }
+  else {
 /* read in and parse the input file */
-  atpg.input(inpFile); // input.cpp
+    atpg.input(inpFile); // input.cpp
+    atpg.timer(stdout,"for reading in circuit");
+    
+    atpg.level_circuit();  // level.cpp
+    atpg.timer(stdout,"for levelling circuit");
+    
+    atpg.rearrange_gate_inputs();  //level.cpp
+    atpg.timer(stdout,"for rearranging gate inputs");
+    
+    atpg.create_dummy_gate(); //init_flist.cpp
+    atpg.timer(stdout,"for creating dummy nodes");
+    
+    atpg.pack_circuit(); //netlist.cpp
+    atpg.timer(stdout,"for packing circuit");
+    
+    atpg.generate_fault_list(); //init_flist.cpp
+    atpg.timer(stdout,"for generating fault list");
+    
+    atpg.save_circuit_cache(); // cache.cpp
+    atpg.timer(stdout,"for writing circuit cache");
+  }
 
 /* if vector file is provided, read it */
-  if(!vetFile.empty()) { atpg.read_vectors(vetFile); }
-  atpg.timer(stdout,"for reading in circuit");
-  
-  atpg.level_circuit();  // level.cpp
-  atpg.timer(stdout,"for levelling circuit");
-  
-  atpg.rearrange_gate_inputs();  //level.cpp
-  atpg.timer(stdout,"for rearranging gate inputs");
-  
-  atpg.create_dummy_gate(); //init_flist.cpp
-  atpg.timer(stdout,"for creating dummy nodes");
+  if(!vetFile.empty()) {
+    atpg.read_vectors(vetFile);
+    atpg.timer(stdout,"for reading in vectors");
+  }
   
-  atpg.generate_fault_list(); //init_flist.cpp
-  atpg.timer(stdout,"for generating fault list");
+  atpg.compile_netlist(); //netlist.cpp
+  atpg.timer(stdout,"for compiling netlist");
   
   atpg.test(); //test.cpp
   if(!atpg.get_tdfsim_only())atpg.compute_fault_coverage(); //init_flist.cpp
@@ -92,38 +135,64 @@ void usage(void) {
    fprintf(stderr, "    -fsim <filename>: fault simulation only; filename provides vectors\n");
    fprintf(stderr, "    -anum <num>: <num> specifies number of vectors per fault\n");
    fprintf(stderr, "    -bt <num>: <num> specifies number of backtracks\n");
+   fprintf(stderr, "    -threads <num>: <num> threads share the fault list in fault simulation\n");
+   fprintf(stderr, "    -packet <num>: <num> faults per fault simulation packet (16, 64, 256 or 512)\n");
+   fprintf(stderr, "    -nocache: neither read nor write the binary circuit cache infile.bin\n");
+   fprintf(stderr, "    -bpat <filename>: also write the generated vectors to filename in binary\n");
    exit(EXIT_FAILURE);
 
 } /* end of usage() */
 
 
+/* read vetFile into the pattern store.  a binary pattern file (see
+ * pattern.cpp) is loaded as is.  the T'...' lines of a text file are read
+ * line by line through one reused buffer, so only the packed patterns are
+ * kept in memory */
 void ATPG::read_vectors(const string& vetFile) {
-  string t, vec;
-  size_t i;
+  FILE *file;
+  char *line = nullptr;
+  size_t capacity = 0;
+  ssize_t len;
+  int i, p;
+  PATTERN_STORE v1;
   
-  ifstream file(vetFile, std::ifstream::in); // open the input vectors' file
-  if(!file) { // if the ifstream obj does not exist, fail to open the file
+  if (patterns.read(vetFile)) { // binary pattern file
+    if (patterns.inputs() == cktin.size()) {
+      /* no launch-on-shift bit: add the last bit of V1, as for a text file */
+      v1.reset(cktin.size() + 1);
+      for (p = 0; p < patterns.size(); p++) {
+        v1.add();
+        for (i = 0; i < cktin.size(); i++) v1.set(p, i, patterns.get(p, i));
+        v1.set(p, cktin.size(), patterns.get(p, cktin.size() - 1));
+      }
+      swap(patterns, v1);
+    }
+    if (patterns.inputs() != cktin.size() + 1) {
+      fprintf(stderr,"File %s has vectors of %d inputs, but the circuit has %d\n",
+              vetFile.c_str(), patterns.inputs(), (int) cktin.size());
+      exit(EXIT_FAILURE);
+    }
+    return;
+  }
+  
+  file = fopen(vetFile.c_str(), "r"); // open the input vectors' file
+  if (file == nullptr) { // fail to open the file
     fprintf(stderr,"File %s could not be opened\n",vetFile.c_str());
     exit(EXIT_FAILURE);
   }
   
-  while(!file.eof() && !file.bad()) {
-    getline(file, t); // get a line from the file
-    if(t[0] != 'T') continue; // if this line is not a vector, ignore it
-    else {
-      vec.clear();
-      for (char c: t) {
-        if (c == 'T') continue;  // ignore "T"
-        if (c == '\'') continue; // ignore "'"
-        if (c == ' ') continue;  // ignore " "
-        vec.push_back(c);
-      }
-      //cout << "Before erase: " << t << endl;
-      //cout << "After erase: " << vec << endl;
-      vectors.push_back(vec); // append the vectors
+  /* a TDF pattern has one more bit, the value shifted in for V2 */
+  patterns.reset(cktin.size() + 1);
+  while ((len = getline(&line, &capacity, file)) != -1) {
+    if (line[0] != 'T') continue; // if this line is not a vector, ignore it
+    p = patterns.size();
+    /* without the extra bit, the last bit of V1 is shifted in */
+    if (patterns.add(line, line + len) == cktin.size()) { // append the vector
+      patterns.set(p, cktin.size(), patterns.get(p, cktin.size() - 1));
     }
   }
-  file.close(); // close the file
+  free(line);
+  fclose(file); // close the file
 }
 
 void ATPG::set_fsim_only(const bool& b) {
@@ -141,3 +210,19 @@ void ATPG::set_total_attempt_num(const int& i) {
 void ATPG::set_backtrack_limit(const int& i) {
   this->backtrack_limit = i;
 }
+
+void ATPG::set_packet_size(const int& i) {
+  this->packet_size = i;
+}
+
+void ATPG::set_num_of_threads(const int& i) {
+  this->num_of_threads = i;
+}
+
+void ATPG::set_circuit_cache(const bool& b) {
+  this->use_circuit_cache = b;
+}
+
+void ATPG::set_pattern_file(const string& s) {
+  this->pattern_file = s;
+}